@@ -39,8 +39,8 @@ CPPFLAGS        += # Precompiler Flags
 CXXFLAGS        += -std=c++14 \
                    -Wall -Wextra -Wpedantic -Wshadow -Wold-style-cast \
                    -Wcast-align -Wmissing-include-dirs -Wredundant-decls \
-                   -Werror -O2
-LDFLAGS         += # Linker Flags
+                   -Werror -O2 -pthread
+LDFLAGS         += -pthread # Linker Flags
 
 # Makeball list
 # ===============
@@ -0,0 +1,54 @@
+/***********************************************************************/
+/*  Copyright 2015 ToPS                                                */
+/*                                                                     */
+/*  This program is free software; you can redistribute it and/or      */
+/*  modify it under the terms of the GNU  General Public License as    */
+/*  published by the Free Software Foundation; either version 3 of     */
+/*  the License, or (at your option) any later version.                */
+/*                                                                     */
+/*  This program is distributed in the hope that it will be useful,    */
+/*  but WITHOUT ANY WARRANTY; without even the implied warranty of     */
+/*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the      */
+/*  GNU General Public License for more details.                       */
+/*                                                                     */
+/*  You should have received a copy of the GNU General Public License  */
+/*  along with this program; if not, write to the Free Software        */
+/*  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,         */
+/*  MA 02110-1301, USA.                                                */
+/***********************************************************************/
+
+// External headers
+#include "benchmark/benchmark.h"
+
+// ToPS headers
+#include "model/HiddenMarkovModel.hpp"
+#include "model/Sequence.hpp"
+
+#include "helper/HiddenMarkovModel.hpp"
+#include "helper/Sequence.hpp"
+
+using tops::model::Labeler;
+
+using tops::helper::generateRandomHMM;
+using tops::helper::generateRandomSequence;
+
+static void BM_HiddenMarkovModelViterbi(benchmark::State& state) {
+  auto model = generateRandomHMM(state.range_x(), 4);
+  auto sequence = generateRandomSequence(state.range_y(), 4);
+  auto labeler = model->labeler(sequence);
+  while (state.KeepRunning())
+    labeler->labeling(Labeler::method::bestPath);
+}
+
+BENCHMARK(BM_HiddenMarkovModelViterbi)->RangePair(8, 512, 1024, 8 * 1024);
+
+static void BM_HiddenMarkovModelVectorizedViterbi(benchmark::State& state) {
+  auto model = generateRandomHMM(state.range_x(), 4);
+  auto sequence = generateRandomSequence(state.range_y(), 4);
+  auto labeler = model->labeler(sequence);
+  while (state.KeepRunning())
+    labeler->labeling(Labeler::method::vectorizedBestPath);
+}
+
+BENCHMARK(BM_HiddenMarkovModelVectorizedViterbi)->RangePair(
+  8, 512, 1024, 8 * 1024);
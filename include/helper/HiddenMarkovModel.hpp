@@ -26,7 +26,12 @@
 namespace tops {
 namespace helper {
 
+tops::model::HiddenMarkovModelPtr generateRandomHMM(
+    unsigned int state_alphabet_size, unsigned int observation_alphabet_size);
+
 tops::model::HiddenMarkovModelPtr createDishonestCoinCasinoHMM();
+tops::model::HiddenMarkovModelPtr createCircularHMM(
+    unsigned int state_alphabet_size);
 
 }  // namespace helper
 }  // namespace tops
@@ -0,0 +1,101 @@
+/***********************************************************************/
+/*  Copyright 2015 ToPS                                                */
+/*                                                                     */
+/*  This program is free software; you can redistribute it and/or      */
+/*  modify it under the terms of the GNU  General Public License as    */
+/*  published by the Free Software Foundation; either version 3 of     */
+/*  the License, or (at your option) any later version.                */
+/*                                                                     */
+/*  This program is distributed in the hope that it will be useful,    */
+/*  but WITHOUT ANY WARRANTY; without even the implied warranty of     */
+/*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the      */
+/*  GNU General Public License for more details.                       */
+/*                                                                     */
+/*  You should have received a copy of the GNU General Public License  */
+/*  along with this program; if not, write to the Free Software        */
+/*  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,         */
+/*  MA 02110-1301, USA.                                                */
+/***********************************************************************/
+
+#ifndef TOPS_MODEL_ALIGNED_ALLOCATOR_
+#define TOPS_MODEL_ALIGNED_ALLOCATOR_
+
+// Standard headers
+#include <new>
+#include <cstddef>
+#include <cstdint>
+
+namespace tops {
+namespace model {
+
+/**
+ * @class AlignedAllocator
+ * @brief Allocator whose blocks start at a multiple of `Alignment` bytes.
+ *
+ * The default alignment matches the size of a cache line, so that the
+ * first element of a dynamic programming table never straddles two lines.
+ */
+template<typename T, std::size_t Alignment = 64>
+class AlignedAllocator {
+  static_assert((Alignment & (Alignment - 1)) == 0,
+                "Alignment must be a power of two");
+
+ public:
+  // Aliases
+  using value_type = T;
+  using size_type = std::size_t;
+  using difference_type = std::ptrdiff_t;
+
+  template<typename U>
+  struct rebind { using other = AlignedAllocator<U, Alignment>; };
+
+  // Constructors
+  AlignedAllocator() noexcept = default;
+
+  template<typename U>
+  AlignedAllocator(const AlignedAllocator<U, Alignment>&) noexcept {
+  }
+
+  // Concrete methods
+  T* allocate(size_type n) {
+    // Reserve room for the alignment slack and for the original pointer,
+    // which is stored right before the aligned block
+    void* raw = ::operator new(n * sizeof(T) + Alignment + sizeof(void*));
+
+    auto address = reinterpret_cast<std::uintptr_t>(raw) + sizeof(void*);
+    address = (address + Alignment - 1) & ~(Alignment - 1);
+
+    reinterpret_cast<void**>(address)[-1] = raw;
+    return reinterpret_cast<T*>(address);
+  }
+
+  void deallocate(T* pointer, size_type /* n */) noexcept {
+    if (pointer == nullptr) return;
+    ::operator delete(reinterpret_cast<void**>(pointer)[-1]);
+  }
+};
+
+/*----------------------------------------------------------------------------*/
+/*                              FRIEND FUNCTIONS                              */
+/*----------------------------------------------------------------------------*/
+
+template<typename T, typename U, std::size_t Alignment>
+bool operator==(const AlignedAllocator<T, Alignment>&,
+                const AlignedAllocator<U, Alignment>&) noexcept {
+  return true;
+}
+
+/*----------------------------------------------------------------------------*/
+
+template<typename T, typename U, std::size_t Alignment>
+bool operator!=(const AlignedAllocator<T, Alignment>&,
+                const AlignedAllocator<U, Alignment>&) noexcept {
+  return false;
+}
+
+/*----------------------------------------------------------------------------*/
+
+}  // namespace model
+}  // namespace tops
+
+#endif  // TOPS_MODEL_ALIGNED_ALLOCATOR_
@@ -0,0 +1,64 @@
+/***********************************************************************/
+/*  Copyright 2015 ToPS                                                */
+/*                                                                     */
+/*  This program is free software; you can redistribute it and/or      */
+/*  modify it under the terms of the GNU  General Public License as    */
+/*  published by the Free Software Foundation; either version 3 of     */
+/*  the License, or (at your option) any later version.                */
+/*                                                                     */
+/*  This program is distributed in the hope that it will be useful,    */
+/*  but WITHOUT ANY WARRANTY; without even the implied warranty of     */
+/*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the      */
+/*  GNU General Public License for more details.                       */
+/*                                                                     */
+/*  You should have received a copy of the GNU General Public License  */
+/*  along with this program; if not, write to the Free Software        */
+/*  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,         */
+/*  MA 02110-1301, USA.                                                */
+/***********************************************************************/
+
+#ifndef TOPS_MODEL_BEAM_
+#define TOPS_MODEL_BEAM_
+
+// Standard headers
+#include <limits>
+#include <cstddef>
+
+namespace tops {
+namespace model {
+
+/**
+ * @class Beam
+ * @brief Pruning criteria of a beam-search Viterbi decoding, and the
+ *        report of the last decoding that used them.
+ *
+ * At each position, only the states whose log-probability is at most
+ * `margin` below the maximum of the column are kept and, if `width` is
+ * not zero, only the `width` best of them. The following position is
+ * computed from these states only.
+ */
+struct Beam {
+  // Pruning criteria
+  double margin = std::numeric_limits<double>::infinity();
+  unsigned int width = 0;
+
+  // Whether to compute score_loss_bound (which costs one more sweep)
+  bool bounded = false;
+
+  // Report of the last decoding, counting only reachable cells (those
+  // with a nonzero score, which the exact algorithm would extend)
+  std::size_t cells = 0;
+  std::size_t pruned_cells = 0;
+
+  // Upper bound of the log-probability lost by the pruning
+  double score_loss_bound = 0;
+
+  double pruningRate() const {
+    return cells == 0 ? 0.0 : static_cast<double>(pruned_cells) / cells;
+  }
+};
+
+}  // namespace model
+}  // namespace tops
+
+#endif  // TOPS_MODEL_BEAM_
@@ -22,6 +22,8 @@
 
 // Standard headers
 #include <memory>
+#include <random>
+#include <vector>
 #include <utility>
 
 // Internal headers
@@ -71,6 +73,33 @@ class CachedLabeler : public SimpleLabeler<Model> {
     CALL_MEMBER_FUNCTION_DELEGATOR(labeling, chosen_method);
   }
 
+  Estimation<Labeling<Sequence>>
+  labeling(Beam& beam) const override {
+    lazyInitializeCache();
+    CALL_MEMBER_FUNCTION_DELEGATOR(labeling, beam);
+  }
+
+  Estimation<Labeling<Sequence>>
+  labeling(Posteriors& posteriors) const override {
+    lazyInitializeCache();
+    CALL_MEMBER_FUNCTION_DELEGATOR(labeling, posteriors);
+  }
+
+  Estimation<Labeling<Sequence>>
+  labeling(NBest& nbest) const override {
+    lazyInitializeCache();
+    CALL_MEMBER_FUNCTION_DELEGATOR(labeling, nbest);
+  }
+
+  std::vector<Estimation<Labeling<Sequence>>>
+  sampling(unsigned int number_of_samples,
+           RandomNumberGeneratorPtr rng = RNGAdapter<std::mt19937>::make(),
+           unsigned int number_of_threads = 0) const override {
+    lazyInitializeCache();
+    CALL_MEMBER_FUNCTION_DELEGATOR(sampling,
+                                   number_of_samples, rng, number_of_threads);
+  }
+
   // Virtual methods
   virtual void initializeCache() const {
     CALL_MEMBER_FUNCTION_DELEGATOR(initializeCache, /* void */);
@@ -92,8 +121,11 @@ class CachedLabeler : public SimpleLabeler<Model> {
 
   // Constructors
   CachedLabeler(ModelPtr model, Sequence sequence,
-                std::vector<Sequence> other_sequences = {}, Cache cache = Cache())
-      : Base(std::move(model), std::move(sequence), std::move(other_sequences)),
+                std::vector<Sequence> other_sequences = {},
+                Labeler::memory memory_mode = Labeler::memory::full,
+                Cache cache = Cache())
+      : Base(std::move(model), std::move(sequence),
+             std::move(other_sequences), memory_mode),
         _cache(std::move(cache)) {
   }
 
@@ -108,6 +140,7 @@ class CachedLabeler : public SimpleLabeler<Model> {
 
   // Delegators
   GENERATE_MEMBER_FUNCTION_DELEGATOR(labeling, _model)
+  GENERATE_MEMBER_FUNCTION_DELEGATOR(sampling, _model)
   GENERATE_MEMBER_FUNCTION_DELEGATOR(initializeCache, _model)
 };
 
@@ -0,0 +1,163 @@
+/***********************************************************************/
+/*  Copyright 2015 ToPS                                                */
+/*                                                                     */
+/*  This program is free software; you can redistribute it and/or      */
+/*  modify it under the terms of the GNU  General Public License as    */
+/*  published by the Free Software Foundation; either version 3 of     */
+/*  the License, or (at your option) any later version.                */
+/*                                                                     */
+/*  This program is distributed in the hope that it will be useful,    */
+/*  but WITHOUT ANY WARRANTY; without even the implied warranty of     */
+/*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the      */
+/*  GNU General Public License for more details.                       */
+/*                                                                     */
+/*  You should have received a copy of the GNU General Public License  */
+/*  along with this program; if not, write to the Free Software        */
+/*  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,         */
+/*  MA 02110-1301, USA.                                                */
+/***********************************************************************/
+
+#ifndef TOPS_MODEL_CHUNKED_VITERBI_
+#define TOPS_MODEL_CHUNKED_VITERBI_
+
+// Standard headers
+#include <memory>
+#include <vector>
+#include <utility>
+#include <cstddef>
+
+// Internal headers
+#include "model/Labeling.hpp"
+#include "model/Sequence.hpp"
+#include "model/Estimation.hpp"
+#include "model/ThreadPool.hpp"
+#include "model/GeneralizedHiddenMarkovModel.hpp"
+
+namespace tops {
+namespace model {
+
+// Forward declaration
+class ChunkedViterbi;
+
+/**
+ * @typedef ChunkedViterbiPtr
+ * @brief Alias of pointer to ChunkedViterbi.
+ */
+using ChunkedViterbiPtr = std::shared_ptr<ChunkedViterbi>;
+
+/**
+ * @class ChunkedViterbi
+ * @brief Parallel Viterbi decoder of a GeneralizedHiddenMarkovModel for
+ *        observations too long to be decoded by a single thread.
+ *
+ * The observation is cut into chunks of `chunk_size` symbols, and each
+ * chunk is decoded with `overlap` more symbols on each side (fewer at the
+ * ends of the observation). The chunks are decoded concurrently by a pool
+ * of threads kept by the decoder, so each worker holds tables for
+ * `chunk_size + 2·overlap` symbols, whatever the observation's length.
+ *
+ * Two consecutive chunks are stitched in the region decoded by both, at
+ * the segment boundary closest to the limit between them where both
+ * labelings agree on the states at each side. As `overlap` is at least
+ * the longest segment of the model, the stitched labeling is usually the
+ * best path of the whole observation. When two windows have no such
+ * boundary, they are joined and decoded again as a single window, so the
+ * stitched labeling never crosses a seam through an impossible
+ * transition.
+ */
+class ChunkedViterbi {
+ public:
+  // Aliases
+  using Self = ChunkedViterbi;
+  using SelfPtr = ChunkedViterbiPtr;
+
+  // Inner classes
+  struct Seam {
+    std::size_t position;  // first label taken from the following window
+  };
+
+  /*============================[ STATIC METHODS ]============================*/
+
+  /**
+   * Creates a chunked decoder.
+   * @param model Trained model
+   * @param chunk_size Number of labels taken from each chunk (at least 1)
+   * @param overlap Number of symbols decoded on each side of a chunk (at
+   *        least the maxDuration() of every state, or OutOfRange)
+   * @param number_of_threads Size of the pool (0 for one per hardware
+   *        thread)
+   * @return New chunked decoder
+   */
+  static SelfPtr make(GeneralizedHiddenMarkovModelPtr model,
+                      unsigned int chunk_size,
+                      unsigned int overlap,
+                      unsigned int number_of_threads = 0);
+
+  /*==========================[ CONCRETE METHODS ]============================*/
+
+  /**
+   * Decodes an observation chunk by chunk.
+   * @param observation Observed symbols
+   * @return Stitched labeling and its joint probability in the model
+   */
+  Estimation<Labeling<Sequence>> labeling(const Sequence& observation);
+
+  /**
+   * Gets the seams of the last labeling, in order.
+   * @return Positions where each chunk was stitched to the following one
+   */
+  const std::vector<Seam>& seams() const;
+
+  /**
+   * Gets how many windows the last labeling decoded again, after finding
+   * no agreed boundary between two of them.
+   * @return Number of joined windows decoded
+   */
+  unsigned int redecodedWindows() const;
+
+  /**
+   * Decodes the whole observation of a stitched labeling at once and
+   * compares the labels (at the cost of a full Viterbi decoding).
+   * @param stitched Labeling returned by labeling()
+   * @return Ranges [begin, end) where the labels differ
+   */
+  std::vector<std::pair<std::size_t, std::size_t>>
+  differences(const Labeling<Sequence>& stitched) const;
+
+ protected:
+  // Instance variables
+  GeneralizedHiddenMarkovModelPtr _model;
+  unsigned int _chunk_size;
+  unsigned int _overlap;
+  ThreadPoolPtr _pool;
+
+  std::vector<Seam> _seams;
+  unsigned int _redecoded_windows = 0;
+
+  // Constructors
+  ChunkedViterbi(GeneralizedHiddenMarkovModelPtr model,
+                 unsigned int chunk_size,
+                 unsigned int overlap,
+                 unsigned int number_of_threads);
+
+ private:
+  // Inner classes
+  struct Window {
+    std::size_t limit;  // first label of its chunks
+    std::size_t begin;  // first symbol decoded
+    std::size_t end;    // one past the last symbol decoded
+    Sequence labels;    // of [begin, end)
+  };
+
+  // Concrete methods
+  Sequence decode(const Sequence& observation,
+                  std::size_t begin, std::size_t end) const;
+
+  bool stitch(const Window& left, const Window& right,
+              std::size_t first, std::size_t& position) const;
+};
+
+}  // namespace model
+}  // namespace tops
+
+#endif  // TOPS_MODEL_CHUNKED_VITERBI_
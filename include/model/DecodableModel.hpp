@@ -23,10 +23,13 @@
 // Standard headers
 #include <memory>
 #include <vector>
+#include <cstddef>
+#include <functional>
 
 // Internal headers
 #include "model/Labeler.hpp"
 #include "model/Labeling.hpp"
+#include "model/Estimation.hpp"
 #include "model/Calculator.hpp"
 #include "model/ProbabilisticModel.hpp"
 
@@ -48,6 +51,10 @@ using DecodableModelPtr = std::shared_ptr<DecodableModel>;
  */
 class DecodableModel : public virtual ProbabilisticModel {
  public:
+  // Aliases
+  using Progress
+    = std::function<void(std::size_t labeled, std::size_t total)>;
+
   /*========================[ PURELY VIRTUAL METHODS ]========================*/
 
   /**
@@ -72,21 +79,47 @@ class DecodableModel : public virtual ProbabilisticModel {
    * Factory of Simple/Cached Labelers
    * @param sequence Input sequence to be labeled
    * @param cached Type of Labeler (cached or non-cached)
+   * @param memory_mode Whether the dynamic programming tables are kept
+   *        in full or only at checkpoints (recomputing the rest on demand)
    * @return New instance of LabelerPtr
    */
-  virtual LabelerPtr labeler(const Sequence& sequence,
-                             bool cached = false) = 0;
+  virtual LabelerPtr labeler(
+      const Sequence& sequence,
+      bool cached = false,
+      Labeler::memory memory_mode = Labeler::memory::full) = 0;
 
   /**
    * Factory of Simple/Cached Labelers
    * @param sequence Input sequence to be labeled
    * @param other_sequences Features associated with the input sequence
    * @param cached Type of Labeler (cached or non-cached)
+   * @param memory_mode Whether the dynamic programming tables are kept
+   *        in full or only at checkpoints (recomputing the rest on demand)
    * @return New instance of LabelerPtr
    */
-  virtual LabelerPtr labeler(const Sequence& sequence,
-                             const std::vector<Sequence>& other_sequences,
-                             bool cached = false) = 0;
+  virtual LabelerPtr labeler(
+      const Sequence& sequence,
+      const std::vector<Sequence>& other_sequences,
+      bool cached = false,
+      Labeler::memory memory_mode = Labeler::memory::full) = 0;
+
+  /**
+   * Labels many sequences concurrently. Longer sequences are scheduled
+   * first and each worker reuses the tables of its own cache, so labeling
+   * a batch allocates memory only for the longest sequences.
+   * @param sequences Input sequences to be labeled
+   * @param method Criteria to find the best labeling for the sequences
+   * @param number_of_threads Number of workers (0 for one per hardware
+   *        thread)
+   * @param progress Callback invoked after each labeled sequence (calls
+   *        are serialized, but may come from any worker)
+   * @return The labeled sequences with their probabilities, in input order
+   */
+  virtual std::vector<Estimation<Labeling<Sequence>>> label(
+      const std::vector<Sequence>& sequences,
+      Labeler::method method = Labeler::method::bestPath,
+      unsigned int number_of_threads = 0,
+      Progress progress = nullptr) = 0;
 
   /**
    * Factory of Simple/Cached Calculators
@@ -23,10 +23,12 @@
 // Standard headers
 #include <memory>
 #include <vector>
+#include <functional>
 
 // Internal headers
 #include "model/State.hpp"
 #include "model/Labeler.hpp"
+#include "model/ThreadPool.hpp"
 #include "model/Calculator.hpp"
 #include "model/SimpleLabeler.hpp"
 #include "model/CachedLabeler.hpp"
@@ -134,12 +136,22 @@ class DecodableModelCrtp
   labelingGenerator(RandomNumberGeneratorPtr rng
                       = RNGAdapter<std::mt19937>::make()) override;
 
-  LabelerPtr labeler(const Sequence& sequence,
-                     bool cached = false) override;
+  LabelerPtr labeler(
+      const Sequence& sequence,
+      bool cached = false,
+      Labeler::memory memory_mode = Labeler::memory::full) override;
 
-  LabelerPtr labeler(const Sequence& sequence,
-                     const std::vector<Sequence>& other_sequences,
-                     bool cached = false) override;
+  LabelerPtr labeler(
+      const Sequence& sequence,
+      const std::vector<Sequence>& other_sequences,
+      bool cached = false,
+      Labeler::memory memory_mode = Labeler::memory::full) override;
+
+  std::vector<Estimation<Labeling<Sequence>>> label(
+      const std::vector<Sequence>& sequences,
+      Labeler::method method = Labeler::method::bestPath,
+      unsigned int number_of_threads = 0,
+      Progress progress = nullptr) override;
 
   CalculatorPtr calculator(const Sequence& sequence,
                            bool cached = false) override;
@@ -259,6 +271,54 @@ class DecodableModelCrtp
   virtual Estimation<Labeling<Sequence>>
   labeling(SLPtr labeler, const Labeler::method& method) const = 0;
 
+  /**
+   * Finds an approximation of the best path of a SimpleLabeler's sequence
+   * with a beam search (**without a cache**).
+   * @param labeler Instance of SimpleLabeler
+   * @param beam Pruning criteria, filled with a report of the decoding
+   * @return The labeled sequence with its probability given the model
+   */
+  virtual Estimation<Labeling<Sequence>>
+  labeling(SLPtr labeler, Beam& beam) const = 0;
+
+  /**
+   * Labels each position of a SimpleLabeler's sequence with its most
+   * probable state, keeping only the forward table and the requested
+   * rows of posterior probabilities (**without a cache**).
+   * @param labeler Instance of SimpleLabeler
+   * @param posteriors Requested rows, filled with the posterior tracks
+   * @return The labeled sequence with its probability given the model
+   */
+  virtual Estimation<Labeling<Sequence>>
+  labeling(SLPtr labeler, Posteriors& posteriors) const = 0;
+
+  /**
+   * Finds the most probable distinct labelings of a SimpleLabeler's
+   * sequence (**without a cache**).
+   * @param labeler Instance of SimpleLabeler
+   * @param nbest Number of labelings, filled with the labelings found
+   * @return The best labeled sequence with its probability given the model
+   */
+  virtual Estimation<Labeling<Sequence>>
+  labeling(SLPtr labeler, NBest& nbest) const = 0;
+
+  /**
+   * Draws labelings of a SimpleLabeler's sequence from their posterior
+   * distribution, tracing back the forward table stochastically
+   * (**without a cache**).
+   * @param labeler Instance of SimpleLabeler
+   * @param number_of_samples Number of labelings to be drawn
+   * @param rng Random Number Generator, which seeds each sample
+   * @param number_of_threads Number of workers (0 for one per hardware
+   *        thread)
+   * @return The labeled sequences with their probabilities given the model
+   */
+  virtual std::vector<Estimation<Labeling<Sequence>>>
+  sampling(SLPtr labeler,
+           unsigned int number_of_samples,
+           RandomNumberGeneratorPtr rng,
+           unsigned int number_of_threads) const = 0;
+
   // CachedLabeler
 
   /**
@@ -278,6 +338,55 @@ class DecodableModelCrtp
   virtual Estimation<Labeling<Sequence>>
   labeling(CLPtr labeler, const Labeler::method& method) const = 0;
 
+  /**
+   * Finds an approximation of the best path of a CachedLabeler's sequence
+   * with a beam search (**with a cache**).
+   * @param labeler Instance of CachedLabeler
+   * @param beam Pruning criteria, filled with a report of the decoding
+   * @return The labeled sequence with its probability given the model
+   */
+  virtual Estimation<Labeling<Sequence>>
+  labeling(CLPtr labeler, Beam& beam) const = 0;
+
+  /**
+   * Labels each position of a CachedLabeler's sequence with its most
+   * probable state, keeping only the forward table and the requested
+   * rows of posterior probabilities (**with a cache**).
+   * @param labeler Instance of CachedLabeler
+   * @param posteriors Requested rows, filled with the posterior tracks
+   * @return The labeled sequence with its probability given the model
+   */
+  virtual Estimation<Labeling<Sequence>>
+  labeling(CLPtr labeler, Posteriors& posteriors) const = 0;
+
+  /**
+   * Finds the most probable distinct labelings of a CachedLabeler's
+   * sequence (**with a cache**).
+   * @param labeler Instance of CachedLabeler
+   * @param nbest Number of labelings, filled with the labelings found
+   * @return The best labeled sequence with its probability given the model
+   */
+  virtual Estimation<Labeling<Sequence>>
+  labeling(CLPtr labeler, NBest& nbest) const = 0;
+
+  /**
+   * Draws labelings of a CachedLabeler's sequence from their posterior
+   * distribution, tracing back the forward table stochastically. The
+   * forward table is kept in the cache and reused by later calls
+   * (**with a cache**).
+   * @param labeler Instance of CachedLabeler
+   * @param number_of_samples Number of labelings to be drawn
+   * @param rng Random Number Generator, which seeds each sample
+   * @param number_of_threads Number of workers (0 for one per hardware
+   *        thread)
+   * @return The labeled sequences with their probabilities given the model
+   */
+  virtual std::vector<Estimation<Labeling<Sequence>>>
+  sampling(CLPtr labeler,
+           unsigned int number_of_samples,
+           RandomNumberGeneratorPtr rng,
+           unsigned int number_of_threads) const = 0;
+
   // SimpleCalculator
 
   /**
@@ -361,6 +470,19 @@ class DecodableModelCrtp
                      unsigned int state_alphabet_size,
                      unsigned int observation_alphabet_size);
 
+  // Labeler's helpers
+  using Traceback = std::function<
+    Estimation<Labeling<Sequence>>(RandomNumberGenerator& rng)>;
+
+  std::vector<Estimation<Labeling<Sequence>>>
+  drawTracebacks(unsigned int number_of_samples,
+                 RandomNumberGeneratorPtr rng,
+                 unsigned int number_of_threads,
+                 const Traceback& traceback) const;
+
+  static unsigned int drawIndex(const std::vector<Probability>& weights,
+                                RandomNumberGenerator& rng);
+
  private:
   // Concrete methods
   DerivedPtr make_shared();
@@ -18,9 +18,13 @@
 /***********************************************************************/
 
 // Standard headers
+#include <mutex>
 #include <memory>
 #include <vector>
+#include <random>
+#include <numeric>
 #include <utility>
+#include <algorithm>
 
 namespace tops {
 namespace model {
@@ -97,8 +101,8 @@ GeneratorPtr<Labeling> DecodableModelCrtp<Derived>::labelingGenerator(
 
 template<typename Derived>
 LabelerPtr DecodableModelCrtp<Derived>::labeler(
-    const Sequence& sequence, bool cached) {
-  return labeler(sequence, {}, cached);
+    const Sequence& sequence, bool cached, Labeler::memory memory_mode) {
+  return labeler(sequence, {}, cached, memory_mode);
 }
 
 /*----------------------------------------------------------------------------*/
@@ -107,12 +111,59 @@ template<typename Derived>
 LabelerPtr DecodableModelCrtp<Derived>::labeler(
     const Sequence& sequence,
     const std::vector<Sequence>& other_sequences,
-    bool cached) {
+    bool cached,
+    Labeler::memory memory_mode) {
   using SL = SimpleLabeler<Derived>;
   using CL = CachedLabeler<Derived>;
 
-  return cached ? CL::make(make_shared(), sequence, other_sequences)
-                : SL::make(make_shared(), sequence, other_sequences);
+  return cached
+    ? CL::make(make_shared(), sequence, other_sequences, memory_mode)
+    : SL::make(make_shared(), sequence, other_sequences, memory_mode);
+}
+
+/*----------------------------------------------------------------------------*/
+
+template<typename Derived>
+std::vector<Estimation<Labeling<Sequence>>> DecodableModelCrtp<Derived>::label(
+    const std::vector<Sequence>& sequences,
+    Labeler::method method,
+    unsigned int number_of_threads,
+    Progress progress) {
+  using CL = CachedLabeler<Derived>;
+
+  // Sequences are handed out longest first: when lengths are skewed, the
+  // last sequences to start are the shortest ones, keeping workers busy
+  std::vector<std::size_t> order(sequences.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(),
+    [&sequences] (std::size_t lhs, std::size_t rhs) {
+      return sequences[lhs].size() > sequences[rhs].size();
+    });
+
+  auto pool = ThreadPool::make(number_of_threads);
+  std::vector<typename CL::Cache> workspaces(pool->size());
+  std::vector<Estimation<Labeling<Sequence>>> labelings(sequences.size());
+
+  auto model = make_shared();
+  std::mutex progress_mutex;
+  std::size_t labeled = 0;
+
+  pool->parallelFor(order.size(), [&] (std::size_t i, unsigned int worker) {
+    // The labeler borrows the worker's cache and gives it back afterwards,
+    // so its tables are reused by the next sequence of the same worker
+    auto labeler = CL::make(model, sequences[order[i]],
+                            std::vector<Sequence>(), Labeler::memory::full,
+                            std::move(workspaces[worker]));
+    labelings[order[i]] = labeler->labeling(method);
+    workspaces[worker] = std::move(labeler->cache());
+
+    if (progress) {
+      std::lock_guard<std::mutex> lock(progress_mutex);
+      progress(++labeled, sequences.size());
+    }
+  });
+
+  return labelings;
 }
 
 /*==============================  CALCULATOR  ================================*/
@@ -179,6 +230,60 @@ auto DecodableModelCrtp<Derived>::states() const
 /*                              CONCRETE METHODS                              */
 /*----------------------------------------------------------------------------*/
 
+template<typename Derived>
+std::vector<Estimation<Labeling<Sequence>>>
+DecodableModelCrtp<Derived>::drawTracebacks(
+    unsigned int number_of_samples,
+    RandomNumberGeneratorPtr rng,
+    unsigned int number_of_threads,
+    const Traceback& traceback) const {
+  // Each sample is drawn with its own seed, taken in order from `rng`,
+  // so the samples do not depend on how they are scheduled
+  std::vector<RandomNumberGenerator::result_type> seeds(number_of_samples);
+  for (auto& seed : seeds) seed = (*rng)();
+
+  auto pool = ThreadPool::make(number_of_threads);
+
+  std::vector<RandomNumberGeneratorPtr> generators;
+  for (unsigned int worker = 0; worker < pool->size(); worker++)
+    generators.push_back(RNGAdapter<std::mt19937>::make());
+
+  std::vector<Estimation<Labeling<Sequence>>> samples(number_of_samples);
+  pool->parallelFor(number_of_samples,
+    [&] (std::size_t sample, unsigned int worker) {
+      generators[worker]->seed(seeds[sample]);
+      samples[sample] = traceback(*generators[worker]);
+    });
+
+  return samples;
+}
+
+/*----------------------------------------------------------------------------*/
+
+template<typename Derived>
+unsigned int DecodableModelCrtp<Derived>::drawIndex(
+    const std::vector<Probability>& weights, RandomNumberGenerator& rng) {
+  Probability total = 0;
+  for (const auto& weight : weights) total += weight;
+
+  Probability target = total * Probability(rng.generateDoubleInUnitInterval());
+
+  Probability cumulative = 0;
+  unsigned int index = 0;
+  for (unsigned int i = 0; i < weights.size(); i++) {
+    if (!(Probability(0) < weights[i])) continue;
+    index = i;
+    cumulative += weights[i];
+    if (target < cumulative) break;
+  }
+
+  // Rounding may leave the target above the last sum, which then
+  // draws the last index with a nonzero weight
+  return index;
+}
+
+/*----------------------------------------------------------------------------*/
+
 template<typename Derived>
 std::shared_ptr<Derived> DecodableModelCrtp<Derived>::make_shared() {
   return std::static_pointer_cast<Derived>(
@@ -25,6 +25,7 @@
 
 // Internal headers
 #include "model/Range.hpp"
+#include "model/DurationSupport.hpp"
 #include "model/Serializer.hpp"
 #include "model/Probability.hpp"
 
@@ -43,6 +44,10 @@ using DurationPtr = std::shared_ptr<Duration>;
 /**
  * @class Duration
  * @brief TODO
+ *
+ * Implementations compute their probabilities when they are built, so
+ * that the lookups made by the innermost loops of the GHMM algorithms
+ * take O(1) time.
  */
 class Duration {
  public:
@@ -50,9 +55,13 @@ class Duration {
   virtual SerializerPtr serializer(TranslatorPtr translator) = 0;
 
   virtual RangePtr range() const = 0;
+  virtual DurationSupport support() const = 0;
   virtual unsigned int maximumSize() const = 0;
   virtual Probability probabilityOfLenght(unsigned int length) const = 0;
 
+  // Probability of a segment being at least `length` long
+  virtual Probability survival(unsigned int length) const = 0;
+
   // Destructor
   virtual ~Duration() = default;
 };
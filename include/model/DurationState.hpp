@@ -26,6 +26,7 @@
 
 // Internal headers
 #include "model/Duration.hpp"
+#include "model/Consensus.hpp"
 #include "model/StateCrtp.hpp"
 
 namespace tops {
@@ -65,14 +66,41 @@ class DurationState
   // Constructors
   DurationState(Id id, EmissionModelPtr emission,
                        TransitionModelPtr transition,
-                       DurationPtr duration);
+                       DurationPtr duration,
+                       ConsensusSequence consensus = {},
+                       unsigned int consensus_offset = 0);
 
   // Virtual methods
   virtual DurationPtr duration();
 
+  // Concrete methods
+
+  /**
+   * Gets the symbols a segment of this state must have at the positions
+   * starting at consensusOffset() from its beginning.
+   * @return Consensus of the segments (empty if they are unconstrained)
+   */
+  const ConsensusSequence& consensus() const;
+
+  /**
+   * Gets the position of the consensus relative to the segment's begin.
+   * @return Offset of the first symbol of consensus()
+   */
+  unsigned int consensusOffset() const;
+
+  /**
+   * Checks if a segment may start at a position of a sequence.
+   * @param sequence Observed symbols
+   * @param begin Position where the segment starts
+   * @return If the consensus fits in the sequence and matches it
+   */
+  bool admitsSegmentAt(const Sequence& sequence, unsigned int begin) const;
+
  protected:
   // Instance variables
   DurationPtr _duration;
+  ConsensusSequence _consensus;
+  unsigned int _consensus_offset;
 };
 
 }  // namespace model
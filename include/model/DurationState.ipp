@@ -30,9 +30,13 @@ namespace model {
 template<typename E, typename T>
 DurationState<E, T>::DurationState(Id id, EmissionModelPtr emission,
                                           TransitionModelPtr transition,
-                                          DurationPtr duration)
+                                          DurationPtr duration,
+                                          ConsensusSequence consensus,
+                                          unsigned int consensus_offset)
     : Base(std::move(id), std::move(emission), std::move(transition)),
-      _duration(std::move(duration)) {
+      _duration(std::move(duration)),
+      _consensus(std::move(consensus)),
+      _consensus_offset(consensus_offset) {
 }
 
 /*----------------------------------------------------------------------------*/
@@ -44,6 +48,35 @@ DurationPtr DurationState<E, T>::duration() {
   return _duration;
 }
 
+/*----------------------------------------------------------------------------*/
+/*                             CONCRETE METHODS                               */
+/*----------------------------------------------------------------------------*/
+
+template<typename E, typename T>
+const ConsensusSequence& DurationState<E, T>::consensus() const {
+  return _consensus;
+}
+
+/*----------------------------------------------------------------------------*/
+
+template<typename E, typename T>
+unsigned int DurationState<E, T>::consensusOffset() const {
+  return _consensus_offset;
+}
+
+/*----------------------------------------------------------------------------*/
+
+template<typename E, typename T>
+bool DurationState<E, T>::admitsSegmentAt(const Sequence& sequence,
+                                          unsigned int begin) const {
+  auto first = begin + _consensus_offset;
+  if (first + _consensus.size() > sequence.size()) return false;
+
+  for (unsigned int j = 0; j < _consensus.size(); j++)
+    if (!_consensus[j].is(sequence[first + j])) return false;
+  return true;
+}
+
 /*----------------------------------------------------------------------------*/
 
 }  // namespace model
@@ -0,0 +1,175 @@
+/***********************************************************************/
+/*  Copyright 2015 ToPS                                                */
+/*                                                                     */
+/*  This program is free software; you can redistribute it and/or      */
+/*  modify it under the terms of the GNU  General Public License as    */
+/*  published by the Free Software Foundation; either version 3 of     */
+/*  the License, or (at your option) any later version.                */
+/*                                                                     */
+/*  This program is distributed in the hope that it will be useful,    */
+/*  but WITHOUT ANY WARRANTY; without even the implied warranty of     */
+/*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the      */
+/*  GNU General Public License for more details.                       */
+/*                                                                     */
+/*  You should have received a copy of the GNU General Public License  */
+/*  along with this program; if not, write to the Free Software        */
+/*  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,         */
+/*  MA 02110-1301, USA.                                                */
+/***********************************************************************/
+
+#ifndef TOPS_MODEL_DURATION_SUPPORT_
+#define TOPS_MODEL_DURATION_SUPPORT_
+
+// Standard headers
+#include <vector>
+#include <cstddef>
+#include <iterator>
+#include <algorithm>
+
+namespace tops {
+namespace model {
+
+/**
+ * @class DurationSupport
+ * @brief Lengths that a Duration may give to a segment, either as an
+ *        arithmetic progression `first, first + stride, ...` up to `last`
+ *        or as a sorted list of lengths.
+ *
+ * Unlike a Range, a support is a plain value: it is copied and iterated
+ * with a range-based for loop, without any allocation or virtual call.
+ * A support made from a list only points to it, so the list must outlive
+ * the support (durations keep theirs as instance variables).
+ */
+class DurationSupport {
+ public:
+  // Aliases
+  using size_type = std::size_t;
+
+  // Inner classes
+  class iterator {
+   public:
+    // Aliases
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = unsigned int;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const unsigned int*;
+    using reference = const unsigned int&;
+
+    // Constructors
+    iterator(const unsigned int* position,
+             unsigned int length, unsigned int stride)
+        : _position(position), _length(length), _stride(stride) {
+    }
+
+    // Concrete methods
+    reference operator*() const {
+      return _position ? *_position : _length;
+    }
+
+    iterator& operator++() {
+      if (_position)
+        ++_position;
+      else
+        _length += _stride;
+      return *this;
+    }
+
+    iterator operator++(int) {
+      auto it = *this;
+      ++*this;
+      return it;
+    }
+
+    bool operator==(const iterator& other) const {
+      return _position == other._position && _length == other._length;
+    }
+
+    bool operator!=(const iterator& other) const {
+      return !(*this == other);
+    }
+
+   private:
+    // Instance variables
+    const unsigned int* _position;  // in a list, or null in a progression
+    unsigned int _length;
+    unsigned int _stride;
+  };
+
+  // Constructors
+  DurationSupport() = default;
+
+  DurationSupport(unsigned int first, unsigned int last,
+                  unsigned int stride = 1)
+      : _first(first), _stride(std::max(1u, stride)),
+        _size(last < first ? 0 : (last - first) / _stride + 1) {
+  }
+
+  explicit DurationSupport(const std::vector<unsigned int>& lengths)
+      : _lengths(lengths.data()), _size(lengths.size()) {
+  }
+
+  // Concrete methods
+
+  /**
+   * Restricts the support to lengths no longer than a limit.
+   * @param limit Longest length kept
+   * @return Lengths of the support that are at most `limit`
+   */
+  DurationSupport upTo(unsigned int limit) const {
+    if (_size == 0 || limit < first()) return DurationSupport();
+
+    DurationSupport support = *this;
+    if (_lengths) {
+      support._size = static_cast<unsigned int>(
+        std::upper_bound(_lengths, _lengths + _size, limit) - _lengths);
+    } else {
+      support._size = std::min(_size, (limit - _first) / _stride + 1);
+    }
+    return support;
+  }
+
+  iterator begin() const {
+    if (_lengths) return iterator(_lengths, 0, 0);
+    return iterator(nullptr, _first, _stride);
+  }
+
+  iterator end() const {
+    if (_lengths) return iterator(_lengths + _size, 0, 0);
+    return iterator(nullptr, _first + _size * _stride, _stride);
+  }
+
+  bool empty() const {
+    return _size == 0;
+  }
+
+  size_type size() const {
+    return _size;
+  }
+
+  unsigned int first() const {
+    if (_lengths) return _size == 0 ? 0 : _lengths[0];
+    return _first;
+  }
+
+  unsigned int last() const {
+    if (_size == 0) return 0;
+    if (_lengths) return _lengths[_size - 1];
+    return _first + (_size - 1) * _stride;
+  }
+
+  unsigned int stride() const {
+    return _stride;
+  }
+
+ private:
+  // Instance variables
+  const unsigned int* _lengths = nullptr;  // sorted, if not a progression
+  unsigned int _first = 1;
+  unsigned int _stride = 1;
+  unsigned int _size = 0;
+};
+
+}  // namespace model
+}  // namespace tops
+
+#endif  // TOPS_MODEL_DURATION_SUPPORT_
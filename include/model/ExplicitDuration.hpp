@@ -22,6 +22,7 @@
 
 // Standard headers
 #include <memory>
+#include <vector>
 
 // Internal headers
 #include "model/DurationCrtp.hpp"
@@ -42,6 +43,11 @@ using ExplicitDurationPtr = std::shared_ptr<ExplicitDuration>;
 /**
  * @class ExplicitDuration
  * @brief TODO
+ *
+ * The probabilities of all lengths in the range of the duration, and the
+ * survival function over them, are tabulated by the constructor. Its
+ * support lists only the lengths with nonzero probability, so histograms
+ * with gaps (or phased run lengths) skip the impossible ones.
  */
 class ExplicitDuration : public DurationCrtp<ExplicitDuration> {
  public:
@@ -56,13 +62,19 @@ class ExplicitDuration : public DurationCrtp<ExplicitDuration> {
 
   // Overriden methods
   RangePtr range() const override;
+  DurationSupport support() const override;
   unsigned int maximumSize() const override;
   Probability probabilityOfLenght(unsigned int length) const override;
+  Probability survival(unsigned int length) const override;
 
  private:
   // Instance variables
   ProbabilisticModelPtr _duration;
   unsigned int _max_duration_size;
+
+  std::vector<Probability> _probabilities;  // length
+  std::vector<Probability> _survivals;      // length
+  std::vector<unsigned int> _support;       // lengths with nonzero prob.
 };
 
 }  // namespace model
@@ -21,12 +21,15 @@
 #define TOPS_MODEL_GENERALIZED_HIDDEN_MARKOV_MODEL_
 
 // Standard headers
+#include <mutex>
 #include <memory>
 #include <vector>
 #include <utility>
 
 // Internal headers
 #include "model/Matrix.hpp"
+#include "model/Segment.hpp"
+#include "model/ThreadPool.hpp"
 #include "model/DurationState.hpp"
 #include "model/DecodableModelCrtp.hpp"
 
@@ -46,10 +49,16 @@ using GeneralizedHiddenMarkovModelPtr
 /**
  * @class GeneralizedHiddenMarkovModel
  * @brief TODO
+ *
+ * Each state emits a whole segment, whose length is given by its
+ * Duration.
  */
 class GeneralizedHiddenMarkovModel
     : public DecodableModelCrtp<GeneralizedHiddenMarkovModel> {
  public:
+  // Tags
+  class viterbi_training_algorithm {};
+
   // Aliases
   using Self = GeneralizedHiddenMarkovModel;
   using SelfPtr = GeneralizedHiddenMarkovModelPtr;
@@ -62,6 +71,7 @@ class GeneralizedHiddenMarkovModel
   // Inner classes
   struct Cache : Base::Cache {
     std::vector<EvaluatorPtr<Standard>> observation_evaluators;
+    bool filled_alpha = false;  // by the first call to sampling()
   };
 
   /*=============================[ CONSTRUCTORS ]=============================*/
@@ -73,6 +83,24 @@ class GeneralizedHiddenMarkovModel
       unsigned int observation_alphabet_size,
       unsigned int max_backtracking = 100);
 
+  /*============================[ STATIC METHODS ]============================*/
+
+  // Trainer
+
+  /**
+   * Trains a model with Viterbi training. Every sequence is decoded in
+   * parallel, and the model is re-estimated from the segments of the best
+   * paths: transitions, emissions of states with a DiscreteIIDModel,
+   * lengths of states with an ExplicitDuration and self-transitions of
+   * states with a GeometricDuration. Other models are kept as they are.
+   */
+  static SelfPtr train(TrainerPtr<Standard, Self> trainer,
+                       viterbi_training_algorithm,
+                       GeneralizedHiddenMarkovModelPtr initial_model,
+                       unsigned int max_iterations,
+                       double diff_threshold,
+                       unsigned int number_of_threads = 0);
+
   /*==========================[ OVERRIDEN METHODS ]===========================*/
   /*-------------------------( Probabilistic Model )--------------------------*/
 
@@ -144,12 +172,34 @@ class GeneralizedHiddenMarkovModel
   Estimation<Labeling<Sequence>> labeling(
       CLPtr labeler,
       const Labeler::method& method) const override;
+  Estimation<Labeling<Sequence>> labeling(
+      CLPtr labeler, Beam& beam) const override;
+  Estimation<Labeling<Sequence>> labeling(
+      CLPtr labeler, Posteriors& posteriors) const override;
+  Estimation<Labeling<Sequence>> labeling(
+      CLPtr labeler, NBest& nbest) const override;
+  std::vector<Estimation<Labeling<Sequence>>> sampling(
+      CLPtr labeler,
+      unsigned int number_of_samples,
+      RandomNumberGeneratorPtr rng,
+      unsigned int number_of_threads) const override;
 
   // CachedLabeler
   void initializeCache(CLPtr labeler) override;
   Estimation<Labeling<Sequence>> labeling(
       SLPtr labeler,
       const Labeler::method& method) const override;
+  Estimation<Labeling<Sequence>> labeling(
+      SLPtr labeler, Beam& beam) const override;
+  Estimation<Labeling<Sequence>> labeling(
+      SLPtr labeler, Posteriors& posteriors) const override;
+  Estimation<Labeling<Sequence>> labeling(
+      SLPtr labeler, NBest& nbest) const override;
+  std::vector<Estimation<Labeling<Sequence>>> sampling(
+      SLPtr labeler,
+      unsigned int number_of_samples,
+      RandomNumberGeneratorPtr rng,
+      unsigned int number_of_threads) const override;
 
   // SimpleCalculator
   Probability calculate(
@@ -164,21 +214,114 @@ class GeneralizedHiddenMarkovModel
   void posteriorProbabilities(const Sequence& sequence,
                               Matrix& probabilities) const override;
 
+  /*==========================[ CONCRETE METHODS ]============================*/
+
+  /**
+   * Gets the length of the longest segment of a state considered by the
+   * dynamic programming algorithms. Every algorithm uses this limit, at
+   * both ends of the sequence, so all of them see the same truncated
+   * model and decode in O(T·N·max_backtracking).
+   * @param state Id of the state
+   * @return Maximum size of its duration, or `max_backtracking` if unbounded
+   */
+  unsigned int maxDuration(unsigned int state) const;
+
+  /**
+   * Finds the segments of a labeling that reach the backtracking limit of
+   * their states, whose real length may be longer than the decoded one.
+   * @param label Labels of a sequence (usually its best path)
+   * @return Segments as long as the maxDuration() of their states
+   */
+  std::vector<Segment> saturatedSegments(const Sequence& label) const;
+
+  /**
+   * Computes the cells of each column of the dynamic programming tables
+   * in parallel, with blocks of states of similar estimated cost. Used
+   * by Viterbi, beam search and the forward algorithm; a call that finds
+   * the pool busy (e.g. decoding the sequences of a training set in
+   * parallel) runs sequentially.
+   * @param number_of_threads Size of the pool (0 for one per hardware
+   *        thread, 1 to compute the columns sequentially)
+   */
+  void parallelizeColumns(unsigned int number_of_threads);
+
  protected:
+  // Inner classes
+  struct ColumnPool {
+    ThreadPoolPtr threads;
+    std::mutex mutex;  // held by the algorithm using the threads
+  };
+
   // Instance variables
   unsigned int _max_backtracking;
+  std::shared_ptr<ColumnPool> _column_pool;
 
  private:
+  // Friends
+  friend class Simulator;
+
+  // Inner classes
+  struct SegmentCounts {
+    std::vector<double> initials;                // state
+    BasicMatrix<double> transitions;             // (from state, to state)
+    BasicMatrix<double> emissions;               // (state, symbol)
+    std::vector<std::vector<double>> durations;  // (state, length)
+    Probability likelihood;                      // of all best paths
+  };
+
+  struct CandidateSites {
+    std::vector<char> constrained;          // state
+    std::vector<std::vector<char>> begins;  // (constrained state, position)
+
+    bool admits(unsigned int state, unsigned int begin) const {
+      return !constrained[state] || begins[state][begin];
+    }
+  };
+
   /*==========================[ CONCRETE METHODS ]============================*/
 
+  // Trainer's helpers
+  void resetSegmentCounts(SegmentCounts& counts) const;
+  void accumulateSegmentCounts(const Sequence& xs,
+                               SegmentCounts& counts) const;
+  static void mergeSegmentCounts(SegmentCounts& counts,
+                                 const SegmentCounts& other);
+  SelfPtr maximizeSegmentCounts(const SegmentCounts& counts) const;
+
   // Labeler's helpers
   Estimation<Labeling<Sequence>>
   viterbi(const Sequence& xs, Matrix& gamma,
-          std::vector<EvaluatorPtr<Standard>>& observation_evaluators) const;
+          std::vector<EvaluatorPtr<Standard>>& observation_evaluators,
+          std::vector<Segment>* segments = nullptr) const;
+
+  Estimation<Labeling<Sequence>>
+  beamViterbi(const Sequence& xs, Beam& beam,
+              std::vector<EvaluatorPtr<Standard>>& observation_evaluators)
+      const;
+
+  Estimation<Labeling<Sequence>>
+  listViterbi(const Sequence& xs, NBest& nbest,
+              std::vector<EvaluatorPtr<Standard>>& observation_evaluators)
+      const;
 
   Estimation<Labeling<Sequence>>
   posteriorDecoding(const Sequence& xs, Matrix& probabilities) const;
 
+  // Runs the backward sweep over a ring of as many columns as the
+  // longest duration
+  Estimation<Labeling<Sequence>>
+  fusedPosteriorDecoding(
+      const Sequence& xs, Posteriors& posteriors,
+      std::vector<EvaluatorPtr<Standard>>& observation_evaluators) const;
+
+  std::vector<Estimation<Labeling<Sequence>>>
+  stochasticTraceback(
+      const Sequence& xs, const Matrix& alpha,
+      std::vector<EvaluatorPtr<Standard>>& observation_evaluators,
+      unsigned int number_of_samples,
+      RandomNumberGeneratorPtr rng,
+      unsigned int number_of_threads) const;
+
   // Calculator's helpers
   std::vector<EvaluatorPtr<Standard>>
   initializeObservationEvaluators(const Sequence& xs, bool cached) const;
@@ -190,6 +333,46 @@ class GeneralizedHiddenMarkovModel
   Probability
   backward(const Sequence& sequence, Matrix& beta,
            std::vector<EvaluatorPtr<Standard>>& observation_evaluators) const;
+
+  // Dynamic programming's helpers
+  Probability pathProbability(
+      const Sequence& ys,
+      std::vector<EvaluatorPtr<Standard>>& observation_evaluators) const;
+
+  std::vector<DurationSupport> durationSupports() const;
+
+  // States with a GeometricDuration, which emit one symbol per segment
+  // and are updated with the per-position recursion of a HMM
+  std::vector<char> geometricStates() const;
+
+  // Positions where the segments of states with a consensus may start,
+  // found in one scan of the sequence
+  CandidateSites candidateSites(const Sequence& sequence) const;
+
+  std::vector<std::size_t> columnBlocks(
+      const std::vector<DurationSupport>& supports,
+      std::unique_lock<std::mutex>& lock) const;
+
+  template<typename Cell>
+  void computeColumn(const std::vector<std::size_t>& blocks,
+                     const Cell& cell) const;
+
+  void backwardColumn(
+      const Sequence& sequence, unsigned int i, Matrix& beta,
+      unsigned int columns,
+      const std::vector<DurationSupport>& supports,
+      const std::vector<char>& geometric,
+      const CandidateSites& candidates,
+      std::vector<Probability>& exits,
+      std::vector<EvaluatorPtr<Standard>>& observation_evaluators) const;
+
+  // Best (summed) entry into every state from the segments ending at i,
+  // read once per length by the loops over durations
+  void viterbiEntries(const Matrix& gamma, unsigned int i,
+                      Matrix& entries, IndexMatrix& entry_states) const;
+
+  void forwardEntries(const Matrix& alpha, unsigned int i,
+                      Matrix& entries) const;
 };
 
 }  // namespace model
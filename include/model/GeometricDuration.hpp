@@ -57,13 +57,16 @@ class GeometricDuration : public DurationCrtp<GeometricDuration> {
 
   // Overriden methods
   RangePtr range() const override;
+  DurationSupport support() const override;
   unsigned int maximumSize() const override;
   Probability probabilityOfLenght(unsigned int length) const override;
+  Probability survival(unsigned int length) const override;
 
  private:
   // Instance variables
   unsigned int _id;
   ProbabilisticModelPtr _transition;
+  double _self_transition;
 };
 
 }  // namespace model
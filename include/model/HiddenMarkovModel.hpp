@@ -24,6 +24,7 @@
 #include <memory>
 #include <vector>
 #include <utility>
+#include <functional>
 
 // Internal headers
 #include "model/Matrix.hpp"
@@ -46,24 +47,57 @@ using HiddenMarkovModelPtr = std::shared_ptr<HiddenMarkovModel>;
 /**
  * @class HiddenMarkovModel
  * @brief TODO
+ *
+ * The dynamic programming algorithms read the probabilities of the
+ * states from the dense tables returned by parameters().
  */
 class HiddenMarkovModel
     : public DecodableModelCrtp<HiddenMarkovModel> {
  public:
   // Tags
   class baum_welch_algorithm {};
+  class online_baum_welch_algorithm {};
+  class viterbi_training_algorithm {};
   class maximum_likehood_algorithm {};
 
   // Aliases
   using Self = HiddenMarkovModel;
   using SelfPtr = HiddenMarkovModelPtr;
   using Base = DecodableModelCrtp<Self>;
-  using Cache = Base::Cache;
 
   // Type traits
   using State = typename StateTraits<Self>::State;
   using StatePtr = std::shared_ptr<State>;
 
+  // Inner classes
+  struct Cache : Base::Cache {
+    bool filled_alpha = false;  // by the first call to sampling()
+  };
+
+  struct SparseTransitions {
+    std::vector<unsigned int> offsets;       // state (plus one sentinel)
+    std::vector<unsigned int> states;        // nonzero transition
+    std::vector<Probability> probabilities;  // nonzero transition
+  };
+
+  struct Parameters {
+    std::vector<Probability> initials;  // state
+    Matrix transitions;                 // (from state, to state)
+    Matrix emissions;                   // (state, symbol)
+
+    // Plain log-probabilities, read by the vectorized kernels
+    std::vector<double> log_initials;
+    BasicMatrix<double> log_transitions;
+    BasicMatrix<double> log_emissions;
+
+    // Nonzero transitions, grouped by target (incoming) or source (outgoing)
+    bool sparse = false;
+    SparseTransitions incoming;
+    SparseTransitions outgoing;
+  };
+
+  using ParametersPtr = std::shared_ptr<const Parameters>;
+
   /*=============================[ CONSTRUCTORS ]=============================*/
 
   HiddenMarkovModel(std::vector<StatePtr> states,
@@ -71,14 +105,55 @@ class HiddenMarkovModel
                     unsigned int state_alphabet_size,
                     unsigned int observation_alphabet_size);
 
+  HiddenMarkovModel(const HiddenMarkovModel& other);
+
   /*============================[ STATIC METHODS ]============================*/
 
   // Trainer
+
+  /**
+   * Trains a model with the Baum-Welch algorithm. At each iteration, the
+   * expected counts of the sequences are computed in parallel, merged in
+   * a fixed order and turned into a single new model.
+   */
   static SelfPtr train(TrainerPtr<Standard, Self> trainer,
                        baum_welch_algorithm,
                        HiddenMarkovModelPtr initial_model,
                        unsigned int maxiterations,
-                       double diff_threshold);
+                       double diff_threshold,
+                       unsigned int number_of_threads = 0);
+
+  /**
+   * Trains a model as the Baum-Welch algorithm does, counting only the
+   * best path of each sequence instead of all its paths.
+   */
+  static SelfPtr train(TrainerPtr<Standard, Self> trainer,
+                       viterbi_training_algorithm,
+                       HiddenMarkovModelPtr initial_model,
+                       unsigned int max_iterations,
+                       double diff_threshold,
+                       unsigned int number_of_threads = 0);
+
+  /**
+   * Trains a model with the online Baum-Welch algorithm (stepwise EM),
+   * holding one sequence at a time: the training set and then the
+   * sequences of a stream. The expected counts of each sequence are
+   * interpolated into running statistics, and the model is re-estimated
+   * after every sequence.
+   * @param next_sequence Source of the stream (false when exhausted)
+   * @param decay Exponent of the step size (k + 2)^-decay, in (0.5, 1]
+   *        (OutOfRange otherwise)
+   * @param snapshot_interval Sequences between calls to `snapshot`
+   *        (0 for none)
+   * @param snapshot Callback given a copy of the current model
+   */
+  static SelfPtr train(TrainerPtr<Standard, Self> trainer,
+                       online_baum_welch_algorithm,
+                       HiddenMarkovModelPtr initial_model,
+                       std::function<bool(Sequence&)> next_sequence,
+                       double decay,
+                       unsigned int snapshot_interval = 0,
+                       std::function<void(SelfPtr)> snapshot = nullptr);
   static SelfPtr train(TrainerPtr<Labeling, Self> trainer,
                        maximum_likehood_algorithm,
                        unsigned int state_alphabet_size,
@@ -156,12 +231,34 @@ class HiddenMarkovModel
   Estimation<Labeling<Sequence>> labeling(
       SLPtr labeler,
       const Labeler::method& method) const override;
+  Estimation<Labeling<Sequence>> labeling(
+      SLPtr labeler, Beam& beam) const override;
+  Estimation<Labeling<Sequence>> labeling(
+      SLPtr labeler, Posteriors& posteriors) const override;
+  Estimation<Labeling<Sequence>> labeling(
+      SLPtr labeler, NBest& nbest) const override;
+  std::vector<Estimation<Labeling<Sequence>>> sampling(
+      SLPtr labeler,
+      unsigned int number_of_samples,
+      RandomNumberGeneratorPtr rng,
+      unsigned int number_of_threads) const override;
 
   // CachedLabeler
   void initializeCache(CLPtr labeler) override;
   Estimation<Labeling<Sequence>> labeling(
       CLPtr labeler,
       const Labeler::method& method) const override;
+  Estimation<Labeling<Sequence>> labeling(
+      CLPtr labeler, Beam& beam) const override;
+  Estimation<Labeling<Sequence>> labeling(
+      CLPtr labeler, Posteriors& posteriors) const override;
+  Estimation<Labeling<Sequence>> labeling(
+      CLPtr labeler, NBest& nbest) const override;
+  std::vector<Estimation<Labeling<Sequence>>> sampling(
+      CLPtr labeler,
+      unsigned int number_of_samples,
+      RandomNumberGeneratorPtr rng,
+      unsigned int number_of_threads) const override;
 
   // SimpleCalculator
   Probability calculate(SCPtr calculator,
@@ -176,19 +273,150 @@ class HiddenMarkovModel
   void posteriorProbabilities(const Sequence& sequence,
                               Matrix& probabilities) const override;
 
+  /*==========================[ CONCRETE METHODS ]============================*/
+
+  /**
+   * Gets the dense parameter tables, compiled when the model was built or
+   * last updated. Tables are never changed once published, so a reader
+   * may keep them while the model is updated by another thread.
+   * @return Initial, transition and emission probabilities
+   */
+  ParametersPtr parameters() const;
+
+  /**
+   * Recompiles the parameter tables from the states. Changes made to the
+   * states (or to the models they hold) are only read after this call.
+   */
+  void updateParameters();
+
  private:
+  // Friends
+  friend class StreamingViterbi;
+
+  // Instance variables
+  ParametersPtr _parameters;  // read and replaced atomically
+
+  // Inner classes
+  struct ExpectedCounts {
+    std::vector<double> initials;     // state
+    BasicMatrix<double> transitions;  // (from state, to state)
+    BasicMatrix<double> emissions;    // (state, symbol)
+    Probability likelihood;           // of all counted sequences
+
+    // Workspace, reused by all sequences and iterations
+    Matrix alpha;
+    Matrix beta;
+    BasicMatrix<double> linear_transitions;
+    std::vector<double> scaled_alpha;
+    std::vector<double> scaled_beta;
+  };
+
+  struct PathCandidate {
+    Probability score;       // of the path extended by the candidate
+    Probability transition;  // from the predecessor
+    unsigned int state;      // predecessor
+    unsigned int rank;       // of the predecessor's path
+
+    bool operator<(const PathCandidate& other) const {
+      return score < other.score;
+    }
+  };
+
   /*==========================[ CONCRETE METHODS ]============================*/
 
+  // Parameters' helpers
+  ParametersPtr compileParameters() const;
+  void compileLogParameters(Parameters& parameters) const;
+  void compileSparseTransitions(Parameters& parameters) const;
+
+  // Trainer's helpers
+  using Accumulator
+    = void (Self::*)(const Sequence&, ExpectedCounts&) const;
+
+  static SelfPtr expectationMaximization(TrainerPtr<Standard, Self> trainer,
+                                         HiddenMarkovModelPtr initial_model,
+                                         unsigned int max_iterations,
+                                         double diff_threshold,
+                                         unsigned int number_of_threads,
+                                         Accumulator accumulate);
+
+  void resetExpectedCounts(ExpectedCounts& counts) const;
+  void accumulateExpectedCounts(const Sequence& xs,
+                                ExpectedCounts& counts) const;
+  void accumulateTransitions(const Sequence& xs, unsigned int t,
+                             Probability P, ExpectedCounts& counts) const;
+  void accumulateViterbiCounts(const Sequence& xs,
+                               ExpectedCounts& counts) const;
+  static void mergeExpectedCounts(ExpectedCounts& counts,
+                                  const ExpectedCounts& other);
+  static void interpolateExpectedCounts(ExpectedCounts& counts,
+                                        const ExpectedCounts& other,
+                                        double step);
+  void maximizeExpectedCounts(const ExpectedCounts& counts);
+  void updateStates();
+
   // Labeler's helpers
   Estimation<Labeling<Sequence>>
   viterbi(const Sequence& xs, Matrix& gamma) const;
 
+  // Runs ViterbiKernel, without filling the cached `gamma`
+  Estimation<Labeling<Sequence>>
+  vectorizedViterbi(const Sequence& xs) const;
+
   Estimation<Labeling<Sequence>>
   posteriorDecoding(const Sequence& xs, Matrix& probabilities) const;
 
+  // Keep one column of every sqrt(T) positions, and recompute the
+  // segments between them during the traceback (or the backward pass)
+  Estimation<Labeling<Sequence>>
+  checkpointedViterbi(const Sequence& xs) const;
+
+  Estimation<Labeling<Sequence>>
+  checkpointedPosteriorDecoding(const Sequence& xs) const;
+
+  // Runs the backward sweep over two columns
+  Estimation<Labeling<Sequence>>
+  fusedPosteriorDecoding(const Sequence& xs, Posteriors& posteriors) const;
+
+  // Runs over plain log-probabilities, bounding the score lost with an
+  // optimistic completion of the best pruned state of each position
+  Estimation<Labeling<Sequence>>
+  beamViterbi(const Sequence& xs, Beam& beam) const;
+
+  Estimation<Labeling<Sequence>>
+  listViterbi(const Sequence& xs, NBest& nbest) const;
+
+  Estimation<Labeling<Sequence>>
+  lazyListViterbi(const Sequence& xs, NBest& nbest) const;
+
+  std::vector<Estimation<Labeling<Sequence>>>
+  stochasticTraceback(const Sequence& xs,
+                      const Matrix& alpha,
+                      unsigned int number_of_samples,
+                      RandomNumberGeneratorPtr rng,
+                      unsigned int number_of_threads) const;
+
   // Calculator's helpers
   Probability backward(const Sequence& sequence, Matrix& beta) const;
   Probability forward(const Sequence& sequence, Matrix& alpha) const;
+
+  // Dynamic programming's helpers
+  Probability pathProbability(const Parameters& parameters,
+                              const Sequence& xs,
+                              const Sequence& ys) const;
+  void viterbiColumn(const Parameters& parameters,
+                     Matrix::ConstView previous,
+                     Symbol symbol,
+                     Matrix::View current,
+                     IndexMatrix::View backpointers) const;
+  void forwardColumn(const Parameters& parameters,
+                     Matrix::ConstView previous,
+                     Symbol symbol,
+                     Matrix::View current) const;
+  void backwardColumn(const Parameters& parameters,
+                      Matrix::ConstView next,
+                      Symbol next_symbol,
+                      Matrix::View current) const;
 };
 
 }  // namespace model
@@ -22,11 +22,17 @@
 
 // Standard headers
 #include <memory>
+#include <random>
+#include <vector>
 
 // Internal headers
+#include "model/Beam.hpp"
+#include "model/NBest.hpp"
 #include "model/Labeling.hpp"
+#include "model/Posteriors.hpp"
 #include "model/Sequence.hpp"
 #include "model/Estimation.hpp"
+#include "model/RandomNumberGeneratorAdapter.hpp"
 
 namespace tops {
 namespace model {
@@ -47,18 +53,42 @@ using LabelerPtr = std::shared_ptr<Labeler>;
 class Labeler : public std::enable_shared_from_this<Labeler> {
  public:
   // Enum classes
-  enum class method { bestPath, posteriorDecoding };
+  enum class method {
+    bestPath,
+    posteriorDecoding,
+    vectorizedBestPath  // HMMs: log-probabilities, keeping two columns
+  };
+  enum class memory {
+    full,
+    checkpointed  // O(N sqrt(T)) tables, recomputed and not cached
+  };
 
   // Purely virtual methods
   virtual Estimation<Labeling<Sequence>>
   labeling(const method& method) const = 0;
 
+  virtual Estimation<Labeling<Sequence>>
+  labeling(Beam& beam) const = 0;
+
+  virtual Estimation<Labeling<Sequence>>
+  labeling(Posteriors& posteriors) const = 0;
+
+  virtual Estimation<Labeling<Sequence>>
+  labeling(NBest& nbest) const = 0;
+
+  virtual std::vector<Estimation<Labeling<Sequence>>>
+  sampling(unsigned int number_of_samples,
+           RandomNumberGeneratorPtr rng = RNGAdapter<std::mt19937>::make(),
+           unsigned int number_of_threads = 0) const = 0;
+
   virtual Sequence& sequence() = 0;
   virtual const Sequence& sequence() const = 0;
 
   virtual std::vector<Sequence>& other_sequences() = 0;
   virtual const std::vector<Sequence>& other_sequences() const = 0;
 
+  virtual memory memoryMode() const = 0;
+
   // Destructor
   virtual ~Labeler() = default;
 };
@@ -68,7 +68,7 @@ const std::vector<Target>& Labeling<Target>::other_observations() const {
 
 template<typename Target>
 std::vector<Target>& Labeling<Target>::other_observations() {
-  return const_cast<Target&>(
+  return const_cast<std::vector<Target>&>(
     static_cast<const Labeling*>(this)->other_observations());
 }
 
@@ -22,16 +22,232 @@
 
 // Standard headers
 #include <vector>
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
 
 // Internal headers
 #include "model/Probability.hpp"
+#include "model/AlignedAllocator.hpp"
 
 namespace tops {
 namespace model {
 
-using Matrix = std::vector<std::vector<Probability>>;
+// Forward declaration
+template<typename T>
+class BasicMatrix;
+
+/**
+ * @class MatrixView
+ * @brief Non-owning, possibly strided, view of a row or a column
+ *        of a BasicMatrix.
+ */
+template<typename Value>
+class MatrixView {
+ public:
+  // Aliases
+  using size_type = std::size_t;
+
+  // Inner classes
+  class iterator {
+   public:
+    // Aliases
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = typename std::remove_const<Value>::type;
+    using difference_type = std::ptrdiff_t;
+    using pointer = Value*;
+    using reference = Value&;
+
+    // Constructors
+    iterator(Value* data, size_type stride)
+        : _data(data), _stride(stride) {
+    }
+
+    // Concrete methods
+    reference operator*() const {
+      return *_data;
+    }
+
+    pointer operator->() const {
+      return _data;
+    }
+
+    iterator& operator++() {
+      _data += _stride;
+      return *this;
+    }
+
+    iterator operator++(int) {
+      auto it = *this;
+      _data += _stride;
+      return it;
+    }
+
+    bool operator==(const iterator& other) const {
+      return _data == other._data;
+    }
+
+    bool operator!=(const iterator& other) const {
+      return _data != other._data;
+    }
+
+   private:
+    // Instance variables
+    Value* _data;
+    size_type _stride;
+  };
+
+  // Constructors
+  MatrixView(Value* data, size_type size, size_type stride)
+      : _data(data), _size(size), _stride(stride) {
+  }
+
+  // Views of mutable elements are also read-only views
+  template<typename Other, typename = typename std::enable_if<
+    std::is_same<const Other, Value>::value>::type>
+  MatrixView(const MatrixView<Other>& other)
+      : _data(other.data()), _size(other.size()), _stride(other.stride()) {
+  }
+
+  // Concrete methods
+  Value& operator[](size_type i) const {
+    return _data[i * _stride];
+  }
+
+  size_type size() const {
+    return _size;
+  }
+
+  size_type stride() const {
+    return _stride;
+  }
+
+  Value* data() const {
+    return _data;
+  }
+
+  iterator begin() const {
+    return iterator(_data, _stride);
+  }
+
+  iterator end() const {
+    return iterator(_data + _size * _stride, _stride);
+  }
+
+ private:
+  // Instance variables
+  Value* _data;
+  size_type _size;
+  size_type _stride;
+};
+
+/**
+ * @class BasicMatrix
+ * @brief Dense matrix stored in a single, cache-line aligned block.
+ *
+ * Dynamic programming tables are indexed as `(state, position)`. The
+ * layout decides which of these dimensions is contiguous in memory:
+ * with layout::positionMajor all states of a position are adjacent
+ * (which is what the column sweeps of forward/backward/Viterbi read),
+ * while layout::stateMajor keeps each state's row adjacent.
+ *
+ * Resizing with reset() reuses the allocated block whenever it is large
+ * enough, so a matrix kept in a cache can be refilled for many sequences
+ * without touching the allocator.
+ */
+template<typename T>
+class BasicMatrix {
+ public:
+  // Enum classes
+  enum class layout { stateMajor, positionMajor };
+
+  // Aliases
+  using value_type = T;
+  using size_type = std::size_t;
+  using Storage = std::vector<T, AlignedAllocator<T>>;
+
+  using View = MatrixView<T>;
+  using ConstView = MatrixView<const T>;
+
+  // Constructors
+  BasicMatrix() = default;
+  BasicMatrix(size_type rows, size_type columns,
+              layout chosen_layout = layout::positionMajor,
+              const T& value = T());
+
+  // Concrete methods
+
+  /**
+   * Resizes the matrix and sets all its elements to a given value,
+   * reusing the current storage whenever possible.
+   * @param rows Number of rows (states)
+   * @param columns Number of columns (positions)
+   * @param value Value of every element of the matrix
+   */
+  void reset(size_type rows, size_type columns, const T& value = T());
+
+  /**
+   * Changes the layout of the matrix, preserving its elements.
+   * @param chosen_layout New layout
+   */
+  void relayout(layout chosen_layout);
+
+  /**
+   * Sets all elements of the matrix to a given value.
+   * @param value Value of every element of the matrix
+   */
+  void fill(const T& value);
+
+  T& operator()(size_type row, size_type column);
+  const T& operator()(size_type row, size_type column) const;
+
+  View operator[](size_type row);
+  ConstView operator[](size_type row) const;
+
+  View row(size_type row);
+  ConstView row(size_type row) const;
+
+  View column(size_type column);
+  ConstView column(size_type column) const;
+
+  size_type rows() const;
+  size_type columns() const;
+  layout memoryLayout() const;
+  bool empty() const;
+
+  T* data();
+  const T* data() const;
+
+ private:
+  // Instance variables
+  Storage _storage;
+  size_type _rows = 0;
+  size_type _columns = 0;
+  layout _layout = layout::positionMajor;
+  size_type _row_stride = 0;
+  size_type _column_stride = 1;
+
+  // Concrete methods
+  void updateStrides();
+  size_type index(size_type row, size_type column) const;
+};
+
+/**
+ * @typedef Matrix
+ * @brief Matrix of probabilities, used by the dynamic programming algorithms.
+ */
+using Matrix = BasicMatrix<Probability>;
+
+/**
+ * @typedef IndexMatrix
+ * @brief Matrix of compact indices (backpointers, durations).
+ */
+using IndexMatrix = BasicMatrix<unsigned int>;
 
 }  // namespace model
 }  // namespace tops
 
+// Implementation header
+#include "model/Matrix.ipp"
+
 #endif  // TOPS_MODEL_MATRIX_
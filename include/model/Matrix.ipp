@@ -0,0 +1,196 @@
+/***********************************************************************/
+/*  Copyright 2015 ToPS                                                */
+/*                                                                     */
+/*  This program is free software; you can redistribute it and/or      */
+/*  modify it under the terms of the GNU  General Public License as    */
+/*  published by the Free Software Foundation; either version 3 of     */
+/*  the License, or (at your option) any later version.                */
+/*                                                                     */
+/*  This program is distributed in the hope that it will be useful,    */
+/*  but WITHOUT ANY WARRANTY; without even the implied warranty of     */
+/*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the      */
+/*  GNU General Public License for more details.                       */
+/*                                                                     */
+/*  You should have received a copy of the GNU General Public License  */
+/*  along with this program; if not, write to the Free Software        */
+/*  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,         */
+/*  MA 02110-1301, USA.                                                */
+/***********************************************************************/
+
+// Standard headers
+#include <utility>
+#include <algorithm>
+
+namespace tops {
+namespace model {
+
+/*----------------------------------------------------------------------------*/
+/*                                CONSTRUCTORS                                */
+/*----------------------------------------------------------------------------*/
+
+template<typename T>
+BasicMatrix<T>::BasicMatrix(size_type rows, size_type columns,
+                            layout chosen_layout, const T& value)
+    : _storage(rows * columns, value),
+      _rows(rows), _columns(columns), _layout(chosen_layout) {
+  updateStrides();
+}
+
+/*----------------------------------------------------------------------------*/
+/*                              CONCRETE METHODS                              */
+/*----------------------------------------------------------------------------*/
+
+template<typename T>
+void BasicMatrix<T>::reset(size_type rows, size_type columns, const T& value) {
+  _rows = rows;
+  _columns = columns;
+  _storage.assign(rows * columns, value);
+  updateStrides();
+}
+
+/*----------------------------------------------------------------------------*/
+
+template<typename T>
+void BasicMatrix<T>::relayout(layout chosen_layout) {
+  if (chosen_layout == _layout) return;
+
+  BasicMatrix<T> other(_rows, _columns, chosen_layout);
+  for (size_type r = 0; r < _rows; r++)
+    for (size_type c = 0; c < _columns; c++)
+      other(r, c) = (*this)(r, c);
+
+  *this = std::move(other);
+}
+
+/*----------------------------------------------------------------------------*/
+
+template<typename T>
+void BasicMatrix<T>::fill(const T& value) {
+  std::fill(_storage.begin(), _storage.end(), value);
+}
+
+/*----------------------------------------------------------------------------*/
+
+template<typename T>
+T& BasicMatrix<T>::operator()(size_type row, size_type column) {
+  return _storage[index(row, column)];
+}
+
+/*----------------------------------------------------------------------------*/
+
+template<typename T>
+const T& BasicMatrix<T>::operator()(size_type row, size_type column) const {
+  return _storage[index(row, column)];
+}
+
+/*----------------------------------------------------------------------------*/
+
+template<typename T>
+auto BasicMatrix<T>::operator[](size_type row) -> View {
+  return this->row(row);
+}
+
+/*----------------------------------------------------------------------------*/
+
+template<typename T>
+auto BasicMatrix<T>::operator[](size_type row) const -> ConstView {
+  return this->row(row);
+}
+
+/*----------------------------------------------------------------------------*/
+
+template<typename T>
+auto BasicMatrix<T>::row(size_type row) -> View {
+  return View(_storage.data() + row * _row_stride, _columns, _column_stride);
+}
+
+/*----------------------------------------------------------------------------*/
+
+template<typename T>
+auto BasicMatrix<T>::row(size_type row) const -> ConstView {
+  return ConstView(
+    _storage.data() + row * _row_stride, _columns, _column_stride);
+}
+
+/*----------------------------------------------------------------------------*/
+
+template<typename T>
+auto BasicMatrix<T>::column(size_type column) -> View {
+  return View(_storage.data() + column * _column_stride, _rows, _row_stride);
+}
+
+/*----------------------------------------------------------------------------*/
+
+template<typename T>
+auto BasicMatrix<T>::column(size_type column) const -> ConstView {
+  return ConstView(
+    _storage.data() + column * _column_stride, _rows, _row_stride);
+}
+
+/*----------------------------------------------------------------------------*/
+
+template<typename T>
+auto BasicMatrix<T>::rows() const -> size_type {
+  return _rows;
+}
+
+/*----------------------------------------------------------------------------*/
+
+template<typename T>
+auto BasicMatrix<T>::columns() const -> size_type {
+  return _columns;
+}
+
+/*----------------------------------------------------------------------------*/
+
+template<typename T>
+auto BasicMatrix<T>::memoryLayout() const -> layout {
+  return _layout;
+}
+
+/*----------------------------------------------------------------------------*/
+
+template<typename T>
+bool BasicMatrix<T>::empty() const {
+  return _storage.empty();
+}
+
+/*----------------------------------------------------------------------------*/
+
+template<typename T>
+T* BasicMatrix<T>::data() {
+  return _storage.data();
+}
+
+/*----------------------------------------------------------------------------*/
+
+template<typename T>
+const T* BasicMatrix<T>::data() const {
+  return _storage.data();
+}
+
+/*----------------------------------------------------------------------------*/
+
+template<typename T>
+void BasicMatrix<T>::updateStrides() {
+  if (_layout == layout::positionMajor) {
+    _row_stride = 1;
+    _column_stride = _rows;
+  } else {
+    _row_stride = _columns;
+    _column_stride = 1;
+  }
+}
+
+/*----------------------------------------------------------------------------*/
+
+template<typename T>
+auto BasicMatrix<T>::index(size_type row, size_type column) const
+    -> size_type {
+  return row * _row_stride + column * _column_stride;
+}
+
+/*----------------------------------------------------------------------------*/
+
+}  // namespace model
+}  // namespace tops
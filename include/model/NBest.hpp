@@ -0,0 +1,64 @@
+/***********************************************************************/
+/*  Copyright 2015 ToPS                                                */
+/*                                                                     */
+/*  This program is free software; you can redistribute it and/or      */
+/*  modify it under the terms of the GNU  General Public License as    */
+/*  published by the Free Software Foundation; either version 3 of     */
+/*  the License, or (at your option) any later version.                */
+/*                                                                     */
+/*  This program is distributed in the hope that it will be useful,    */
+/*  but WITHOUT ANY WARRANTY; without even the implied warranty of     */
+/*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the      */
+/*  GNU General Public License for more details.                       */
+/*                                                                     */
+/*  You should have received a copy of the GNU General Public License  */
+/*  along with this program; if not, write to the Free Software        */
+/*  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,         */
+/*  MA 02110-1301, USA.                                                */
+/***********************************************************************/
+
+#ifndef TOPS_MODEL_N_BEST_
+#define TOPS_MODEL_N_BEST_
+
+// Standard headers
+#include <vector>
+
+// Internal headers
+#include "model/Labeling.hpp"
+#include "model/Sequence.hpp"
+#include "model/Estimation.hpp"
+
+namespace tops {
+namespace model {
+
+/**
+ * @class NBest
+ * @brief Number of labelings requested to an N-best Viterbi decoding,
+ *        and the labelings it found.
+ *
+ * By default, each cell of the dynamic programming table keeps its
+ * `size` best partial paths (list Viterbi). With `lazy`, only the best
+ * path of each cell is computed up front, and the following ones are
+ * derived cell by cell when a longer path asks for them, so the cost
+ * grows with the number of paths actually extracted.
+ *
+ * Labelings are distinct: when several segmentations of a
+ * GeneralizedHiddenMarkovModel give the same labels, only the most
+ * probable one is kept. GHMMs keep the back pointers of `size` paths per
+ * state and position, and do not implement `lazy` (NotYetImplemented).
+ */
+struct NBest {
+  // Number of labelings to be found
+  unsigned int size = 1;
+
+  // Whether to extend the lists of paths only on demand
+  bool lazy = false;
+
+  // Labelings found by the last decoding, from the most probable
+  std::vector<Estimation<Labeling<Sequence>>> labelings;
+};
+
+}  // namespace model
+}  // namespace tops
+
+#endif  // TOPS_MODEL_N_BEST_
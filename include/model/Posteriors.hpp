@@ -0,0 +1,59 @@
+/***********************************************************************/
+/*  Copyright 2015 ToPS                                                */
+/*                                                                     */
+/*  This program is free software; you can redistribute it and/or      */
+/*  modify it under the terms of the GNU  General Public License as    */
+/*  published by the Free Software Foundation; either version 3 of     */
+/*  the License, or (at your option) any later version.                */
+/*                                                                     */
+/*  This program is distributed in the hope that it will be useful,    */
+/*  but WITHOUT ANY WARRANTY; without even the implied warranty of     */
+/*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the      */
+/*  GNU General Public License for more details.                       */
+/*                                                                     */
+/*  You should have received a copy of the GNU General Public License  */
+/*  along with this program; if not, write to the Free Software        */
+/*  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,         */
+/*  MA 02110-1301, USA.                                                */
+/***********************************************************************/
+
+#ifndef TOPS_MODEL_POSTERIORS_
+#define TOPS_MODEL_POSTERIORS_
+
+// Standard headers
+#include <vector>
+
+// Internal headers
+#include "model/Matrix.hpp"
+#include "model/Probability.hpp"
+
+namespace tops {
+namespace model {
+
+/**
+ * @class Posteriors
+ * @brief Rows of posterior probabilities requested to a fused posterior
+ *        decoding, and the tracks it fills while decoding.
+ *
+ * The fused decoding keeps only the forward table: each column of
+ * posterior probabilities is computed during the backward sweep, used to
+ * label its position and then discarded, except for the rows of the
+ * states listed in `states`. The backward sweep itself keeps only the
+ * columns that the next ones read.
+ */
+struct Posteriors {
+  // States whose posterior probabilities are kept
+  std::vector<unsigned int> states;
+
+  // Posterior probabilities of the requested states, with rows in the
+  // same order as `states` (requested state, position)
+  Matrix probabilities;
+
+  // Posterior probability of the label chosen for each position
+  std::vector<Probability> max_posteriors;
+};
+
+}  // namespace model
+}  // namespace tops
+
+#endif  // TOPS_MODEL_POSTERIORS_
@@ -54,8 +54,10 @@ class SignalDuration : public DurationCrtp<SignalDuration> {
 
   // Overriden methods
   RangePtr range() const override;
+  DurationSupport support() const override;
   unsigned int maximumSize() const override;
   Probability probabilityOfLenght(unsigned int length) const override;
+  Probability survival(unsigned int length) const override;
 
  private:
   // Instance variables
@@ -22,6 +22,8 @@
 
 // Standard headers
 #include <memory>
+#include <random>
+#include <vector>
 #include <utility>
 
 // Internal headers
@@ -68,6 +70,29 @@ class SimpleLabeler : public Labeler {
     CALL_MEMBER_FUNCTION_DELEGATOR(labeling, chosen_method);
   }
 
+  Estimation<Labeling<Sequence>>
+  labeling(Beam& beam) const override {
+    CALL_MEMBER_FUNCTION_DELEGATOR(labeling, beam);
+  }
+
+  Estimation<Labeling<Sequence>>
+  labeling(Posteriors& posteriors) const override {
+    CALL_MEMBER_FUNCTION_DELEGATOR(labeling, posteriors);
+  }
+
+  Estimation<Labeling<Sequence>>
+  labeling(NBest& nbest) const override {
+    CALL_MEMBER_FUNCTION_DELEGATOR(labeling, nbest);
+  }
+
+  std::vector<Estimation<Labeling<Sequence>>>
+  sampling(unsigned int number_of_samples,
+           RandomNumberGeneratorPtr rng = RNGAdapter<std::mt19937>::make(),
+           unsigned int number_of_threads = 0) const override {
+    CALL_MEMBER_FUNCTION_DELEGATOR(sampling,
+                                   number_of_samples, rng, number_of_threads);
+  }
+
   Sequence& sequence() override {
     return _sequence;
   }
@@ -84,11 +109,16 @@ class SimpleLabeler : public Labeler {
     return _other_sequences;
   }
 
+  Labeler::memory memoryMode() const override {
+    return _memory_mode;
+  }
+
  protected:
   // Instace variables
   ModelPtr _model;
   Sequence _sequence;
   std::vector<Sequence> _other_sequences;
+  Labeler::memory _memory_mode = Labeler::memory::full;
 
   // Constructors
   SimpleLabeler(ModelPtr model, Sequence sequence)
@@ -97,14 +127,17 @@ class SimpleLabeler : public Labeler {
 
   SimpleLabeler(ModelPtr model,
                 Sequence sequence,
-                std::vector<Sequence> other_sequences)
+                std::vector<Sequence> other_sequences,
+                Labeler::memory memory_mode = Labeler::memory::full)
       : _model(std::move(model)),
         _sequence(std::move(sequence)),
-        _other_sequences(std::move(other_sequences)) {
+        _other_sequences(std::move(other_sequences)),
+        _memory_mode(memory_mode) {
   }
 
  private:
   GENERATE_MEMBER_FUNCTION_DELEGATOR(labeling, _model)
+  GENERATE_MEMBER_FUNCTION_DELEGATOR(sampling, _model)
 };
 
 }  // namespace model
@@ -0,0 +1,168 @@
+/***********************************************************************/
+/*  Copyright 2015 ToPS                                                */
+/*                                                                     */
+/*  This program is free software; you can redistribute it and/or      */
+/*  modify it under the terms of the GNU  General Public License as    */
+/*  published by the Free Software Foundation; either version 3 of     */
+/*  the License, or (at your option) any later version.                */
+/*                                                                     */
+/*  This program is distributed in the hope that it will be useful,    */
+/*  but WITHOUT ANY WARRANTY; without even the implied warranty of     */
+/*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the      */
+/*  GNU General Public License for more details.                       */
+/*                                                                     */
+/*  You should have received a copy of the GNU General Public License  */
+/*  along with this program; if not, write to the Free Software        */
+/*  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,         */
+/*  MA 02110-1301, USA.                                                */
+/***********************************************************************/
+
+#ifndef TOPS_MODEL_SIMULATOR_
+#define TOPS_MODEL_SIMULATOR_
+
+// Standard headers
+#include <memory>
+#include <vector>
+#include <cstddef>
+
+// Internal headers
+#include "model/Labeling.hpp"
+#include "model/Sequence.hpp"
+#include "model/ProbabilisticModel.hpp"
+#include "model/HiddenMarkovModel.hpp"
+#include "model/RandomNumberGenerator.hpp"
+#include "model/GeneralizedHiddenMarkovModel.hpp"
+
+namespace tops {
+namespace model {
+
+// Forward declaration
+class Simulator;
+
+/**
+ * @typedef SimulatorPtr
+ * @brief Alias of pointer to Simulator.
+ */
+using SimulatorPtr = std::shared_ptr<Simulator>;
+
+/**
+ * @class Simulator
+ * @brief Bulk generator of labeled sequences of a HiddenMarkovModel or of a
+ *        GeneralizedHiddenMarkovModel.
+ *
+ * All distributions of the model are compiled, once, into alias tables,
+ * so that every draw costs one uniform number and O(1) time regardless of
+ * the size of the alphabet. Sequences are generated segment by segment:
+ * each state draws its duration (always 1 for HMMs), its emissions and its
+ * successor, and the last segment is truncated at the requested length.
+ * Emissions of GHMM states whose model is not a DiscreteIIDModel are drawn
+ * by the model's own generator.
+ *
+ * Bulk simulations draw every sequence from its own stream of random
+ * numbers, seeded by streamSeed(), so the output depends only on the seed
+ * and never on the number of threads.
+ */
+class Simulator {
+ public:
+  // Aliases
+  using Self = Simulator;
+  using SelfPtr = SimulatorPtr;
+
+  /*============================[ STATIC METHODS ]============================*/
+
+  /**
+   * Creates a simulator of a HMM.
+   * @param model Model to be simulated
+   * @return New simulator
+   */
+  static SelfPtr make(HiddenMarkovModelPtr model);
+
+  /**
+   * Creates a simulator of a GHMM.
+   * @param model Model to be simulated
+   * @return New simulator
+   */
+  static SelfPtr make(GeneralizedHiddenMarkovModelPtr model);
+
+  /**
+   * Gets the seed of one of the streams of a bulk simulation.
+   * @param seed Seed of the simulation
+   * @param stream Index of the sequence
+   * @return Seed of the random numbers used by the sequence
+   */
+  static unsigned int streamSeed(unsigned int seed, std::size_t stream);
+
+  /*==========================[ CONCRETE METHODS ]============================*/
+
+  /**
+   * Draws one labeled sequence, reusing the storage of a buffer.
+   * @param size Length of the sequence
+   * @param rng Random Number Generator
+   * @param buffer Labeling replaced by the drawn one
+   */
+  void draw(std::size_t size,
+            RandomNumberGeneratorPtr rng,
+            Labeling<Sequence>& buffer) const;
+
+  /**
+   * Draws many labeled sequences of the same length in parallel.
+   * @param number_of_sequences Number of sequences
+   * @param size Length of each sequence
+   * @param seed Seed of the simulation
+   * @param number_of_threads Number of threads (0 for one per hardware thread)
+   * @return Drawn labelings, one per stream
+   */
+  std::vector<Labeling<Sequence>> simulate(
+      std::size_t number_of_sequences,
+      std::size_t size,
+      unsigned int seed,
+      unsigned int number_of_threads = 0) const;
+
+  /**
+   * Draws one labeled sequence into each of the given buffers in parallel,
+   * reusing their storage.
+   * @param buffers Labelings replaced by the drawn ones, one per stream
+   * @param size Length of each sequence
+   * @param seed Seed of the simulation
+   * @param number_of_threads Number of threads (0 for one per hardware thread)
+   */
+  void simulate(std::vector<Labeling<Sequence>>& buffers,
+                std::size_t size,
+                unsigned int seed,
+                unsigned int number_of_threads = 0) const;
+
+ protected:
+  // Inner classes
+  struct AliasTable {
+    std::vector<unsigned int> outcomes;  // with nonzero probability
+    std::vector<double> thresholds;      // outcome
+    std::vector<unsigned int> aliases;   // outcome, drawn above threshold
+  };
+
+  struct StateTables {
+    AliasTable transition;
+    AliasTable duration;
+    AliasTable emission;
+    ProbabilisticModelPtr emission_model;  // if not in a table
+  };
+
+  // Instance variables
+  AliasTable _initials;
+  std::vector<StateTables> _states;
+
+  // Constructors
+  Simulator() = default;
+
+ private:
+  // Concrete methods
+  static AliasTable aliasTable(const std::vector<unsigned int>& outcomes,
+                               const std::vector<double>& probabilities);
+  static AliasTable aliasTable(const std::vector<Probability>& probabilities);
+  static unsigned int draw(const AliasTable& table,
+                           RandomNumberGenerator& rng);
+};
+
+}  // namespace model
+}  // namespace tops
+
+#endif  // TOPS_MODEL_SIMULATOR_
@@ -0,0 +1,137 @@
+/***********************************************************************/
+/*  Copyright 2015 ToPS                                                */
+/*                                                                     */
+/*  This program is free software; you can redistribute it and/or      */
+/*  modify it under the terms of the GNU  General Public License as    */
+/*  published by the Free Software Foundation; either version 3 of     */
+/*  the License, or (at your option) any later version.                */
+/*                                                                     */
+/*  This program is distributed in the hope that it will be useful,    */
+/*  but WITHOUT ANY WARRANTY; without even the implied warranty of     */
+/*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the      */
+/*  GNU General Public License for more details.                       */
+/*                                                                     */
+/*  You should have received a copy of the GNU General Public License  */
+/*  along with this program; if not, write to the Free Software        */
+/*  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,         */
+/*  MA 02110-1301, USA.                                                */
+/***********************************************************************/
+
+#ifndef TOPS_MODEL_STREAMING_VITERBI_
+#define TOPS_MODEL_STREAMING_VITERBI_
+
+// Standard headers
+#include <memory>
+#include <vector>
+#include <cstddef>
+
+// Internal headers
+#include "model/Matrix.hpp"
+#include "model/Sequence.hpp"
+#include "model/HiddenMarkovModel.hpp"
+
+namespace tops {
+namespace model {
+
+// Forward declaration
+class StreamingViterbi;
+
+/**
+ * @typedef StreamingViterbiPtr
+ * @brief Alias of pointer to StreamingViterbi.
+ */
+using StreamingViterbiPtr = std::shared_ptr<StreamingViterbi>;
+
+/**
+ * @class StreamingViterbi
+ * @brief Incremental Viterbi decoder of a HiddenMarkovModel, for streams
+ *        of symbols that are too long (or unbounded) to be kept in memory.
+ *
+ * Symbols are pushed in chunks of any size. Only the last column of scores
+ * and the backpointers of the labels not yet emitted are kept, in a ring
+ * of `lag` columns. A label is committed (emitted and forgotten) when:
+ *
+ * - all paths still alive at the end of a chunk go through the same state
+ *   at its position (traceback convergence), in which case it is the label
+ *   of the best path of the whole stream; or
+ * - it is `lag` positions behind the last symbol (fixed lag), in which case
+ *   it is the label of the best path of the symbols read so far.
+ *
+ * Memory is O(N·lag) and no label waits for more than `lag` symbols.
+ * Scores are normalized at each position, so the stream may be unbounded.
+ * The decoder reads the parameter tables the model had when it was made.
+ */
+class StreamingViterbi {
+ public:
+  // Aliases
+  using Self = StreamingViterbi;
+  using SelfPtr = StreamingViterbiPtr;
+
+  /*============================[ STATIC METHODS ]============================*/
+
+  /**
+   * Creates an incremental decoder.
+   * @param model Trained model
+   * @param lag Maximum number of labels waiting to be committed (at least 1)
+   * @return New incremental decoder
+   */
+  static SelfPtr make(HiddenMarkovModelPtr model, unsigned int lag);
+
+  /*==========================[ CONCRETE METHODS ]============================*/
+
+  /**
+   * Reads the next symbols of the stream.
+   * @param symbols Chunk of the stream
+   * @return Labels committed while reading the chunk, in order
+   */
+  Sequence push(const Sequence& symbols);
+
+  /**
+   * Ends the stream, committing the labels of the best path that are
+   * still waiting. The decoder can then be used for a new stream.
+   * @return Labels committed at the end of the stream, in order
+   */
+  Sequence finish();
+
+  /**
+   * Gets the number of symbols read from the current stream.
+   * @return Length of the stream
+   */
+  std::size_t position() const;
+
+  /**
+   * Gets the number of labels committed for the current stream.
+   * @return Length of the decoded prefix of the stream
+   */
+  std::size_t committed() const;
+
+ protected:
+  // Instance variables
+  HiddenMarkovModelPtr _model;
+  HiddenMarkovModel::ParametersPtr _parameters;
+  unsigned int _lag;
+
+  Matrix _gamma;       // (state, position % 2)
+  IndexMatrix _psi;    // (state, position % lag)
+  std::vector<char> _alive, _ancestors;
+
+  std::size_t _position = 0;
+  std::size_t _committed = 0;
+
+  // Constructors
+  StreamingViterbi(HiddenMarkovModelPtr model, unsigned int lag);
+
+ private:
+  // Concrete methods
+  void read(Symbol symbol);
+  void converge(Sequence& labels);
+  void commit(std::size_t end, unsigned int state, Sequence& labels);
+  unsigned int trace(unsigned int state,
+                     std::size_t from, std::size_t to) const;
+  unsigned int bestState() const;
+};
+
+}  // namespace model
+}  // namespace tops
+
+#endif  // TOPS_MODEL_STREAMING_VITERBI_
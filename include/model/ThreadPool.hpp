@@ -0,0 +1,132 @@
+/***********************************************************************/
+/*  Copyright 2015 ToPS                                                */
+/*                                                                     */
+/*  This program is free software; you can redistribute it and/or      */
+/*  modify it under the terms of the GNU  General Public License as    */
+/*  published by the Free Software Foundation; either version 3 of     */
+/*  the License, or (at your option) any later version.                */
+/*                                                                     */
+/*  This program is distributed in the hope that it will be useful,    */
+/*  but WITHOUT ANY WARRANTY; without even the implied warranty of     */
+/*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the      */
+/*  GNU General Public License for more details.                       */
+/*                                                                     */
+/*  You should have received a copy of the GNU General Public License  */
+/*  along with this program; if not, write to the Free Software        */
+/*  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,         */
+/*  MA 02110-1301, USA.                                                */
+/***********************************************************************/
+
+#ifndef TOPS_MODEL_THREAD_POOL_
+#define TOPS_MODEL_THREAD_POOL_
+
+// Standard headers
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <condition_variable>
+
+namespace tops {
+namespace model {
+
+// Forward declaration
+class ThreadPool;
+
+/**
+ * @typedef ThreadPoolPtr
+ * @brief Alias of pointer to ThreadPool.
+ */
+using ThreadPoolPtr = std::shared_ptr<ThreadPool>;
+
+/**
+ * @class ThreadPool
+ * @brief Fixed set of threads that run the iterations of parallel loops.
+ *
+ * The thread calling parallelFor() works as worker 0, so a pool of size
+ * one runs every loop sequentially without any synchronization. Workers
+ * are kept alive between loops, so algorithms that iterate (such as the
+ * Baum-Welch algorithm) pay for creating the threads only once.
+ */
+class ThreadPool {
+ public:
+  // Aliases
+  using Self = ThreadPool;
+  using SelfPtr = ThreadPoolPtr;
+  using Task = std::function<void(std::size_t index, unsigned int worker)>;
+
+  /*============================[ STATIC METHODS ]============================*/
+
+  /**
+   * Creates a pool of threads.
+   * @param number_of_threads Size of the pool (0 for one per hardware thread)
+   * @return New pool of threads
+   */
+  static SelfPtr make(unsigned int number_of_threads = 0);
+
+  /**
+   * Splits a list of tasks into blocks of contiguous tasks with similar
+   * total costs. The split depends only on the costs, never on timing.
+   * @param costs Cost of each task
+   * @param number_of_blocks Maximum number of blocks
+   * @return Limits of the blocks (block b is [limits[b], limits[b+1]))
+   */
+  static std::vector<std::size_t> partition(
+      const std::vector<std::size_t>& costs, unsigned int number_of_blocks);
+
+  /*=============================[ CONSTRUCTORS ]=============================*/
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  ~ThreadPool();
+
+  /*==========================[ CONCRETE METHODS ]============================*/
+
+  /**
+   * Runs `task(index, worker)` for every index in [0, size), blocking
+   * until all of them finish. Exceptions are rethrown in the caller.
+   * @param size Number of iterations of the loop
+   * @param task Body of the loop
+   */
+  void parallelFor(std::size_t size, const Task& task);
+
+  /**
+   * Gets the number of workers, counting the calling thread.
+   * @return Size of the pool
+   */
+  unsigned int size() const;
+
+ protected:
+  // Instance variables
+  std::vector<std::thread> _threads;
+
+  std::mutex _mutex;
+  std::condition_variable _start;
+  std::condition_variable _finish;
+
+  const Task* _task = nullptr;
+  std::size_t _size = 0;
+  std::atomic<std::size_t> _next;
+  std::size_t _generation = 0;
+  unsigned int _running = 0;
+  bool _stop = false;
+  std::exception_ptr _exception;
+
+  // Constructors
+  explicit ThreadPool(unsigned int number_of_threads);
+
+ private:
+  // Concrete methods
+  void work(unsigned int worker);
+  void runTasks(unsigned int worker);
+};
+
+}  // namespace model
+}  // namespace tops
+
+#endif  // TOPS_MODEL_THREAD_POOL_
@@ -0,0 +1,73 @@
+/***********************************************************************/
+/*  Copyright 2015 ToPS                                                */
+/*                                                                     */
+/*  This program is free software; you can redistribute it and/or      */
+/*  modify it under the terms of the GNU  General Public License as    */
+/*  published by the Free Software Foundation; either version 3 of     */
+/*  the License, or (at your option) any later version.                */
+/*                                                                     */
+/*  This program is distributed in the hope that it will be useful,    */
+/*  but WITHOUT ANY WARRANTY; without even the implied warranty of     */
+/*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the      */
+/*  GNU General Public License for more details.                       */
+/*                                                                     */
+/*  You should have received a copy of the GNU General Public License  */
+/*  along with this program; if not, write to the Free Software        */
+/*  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,         */
+/*  MA 02110-1301, USA.                                                */
+/***********************************************************************/
+
+#ifndef TOPS_MODEL_VITERBI_KERNEL_
+#define TOPS_MODEL_VITERBI_KERNEL_
+
+namespace tops {
+namespace model {
+
+/**
+ * @class ViterbiKernel
+ * @brief Max-plus recursion of the Viterbi algorithm over log-probabilities.
+ *
+ * Each step computes a whole column of the Viterbi table, processing
+ * several target states per instruction when the processor supports
+ * a vector extension. The extension is detected at runtime, so a single
+ * binary runs (with the scalar fallback) on any x86 processor.
+ */
+class ViterbiKernel {
+ public:
+  // Enum classes
+  enum class extension { scalar, sse4, avx2 };
+
+  // Static methods
+
+  /**
+   * Gets the widest vector extension supported by the processor.
+   * @return Extension used by default
+   */
+  static extension available();
+
+  /**
+   * Computes one column of the Viterbi table. For each target state `k`:
+   * `current[k] = max_p (previous[p] + transitions[p * n + k])
+   *               + emissions[k]`,
+   * with `backpointers[k]` holding the first `p` that attains the maximum.
+   * @param chosen_extension Vector extension used in the computation
+   * @param n Number of states
+   * @param previous Previous column of the table (`n` elements)
+   * @param transitions Log-transitions, contiguous by source state (`n * n`)
+   * @param emissions Log-emissions of the current symbol (`n` elements)
+   * @param current Current column of the table (`n` elements)
+   * @param backpointers Best predecessor of each state (`n` elements)
+   */
+  static void step(extension chosen_extension,
+                   unsigned int n,
+                   const double* previous,
+                   const double* transitions,
+                   const double* emissions,
+                   double* current,
+                   unsigned int* backpointers);
+};
+
+}  // namespace model
+}  // namespace tops
+
+#endif  // TOPS_MODEL_VITERBI_KERNEL_
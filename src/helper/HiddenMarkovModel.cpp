@@ -25,6 +25,7 @@
 #include <vector>
 
 // Internal headers
+#include "helper/Random.hpp"
 #include "helper/DiscreteIIDModel.hpp"
 
 #include "model/Probability.hpp"
@@ -32,10 +33,41 @@
 namespace tops {
 namespace helper {
 
+/*----------------------------------------------------------------------------*/
+/*                              LOCAL FUNCTIONS                               */
+/*----------------------------------------------------------------------------*/
+
+static model::DiscreteIIDModelPtr generateRandomDistribution(
+    unsigned int alphabet_size) {
+  std::vector<double> counts;
+  for (unsigned int i = 0; i < alphabet_size; i++)
+    counts.push_back(1 + generateRandomInteger(alphabet_size));
+  return model::DiscreteIIDModel::make(
+    model::DiscreteIIDModel::normalize(counts));
+}
+
 /*----------------------------------------------------------------------------*/
 /*                                 FUNCTIONS                                  */
 /*----------------------------------------------------------------------------*/
 
+model::HiddenMarkovModelPtr generateRandomHMM(
+    unsigned int state_alphabet_size, unsigned int observation_alphabet_size) {
+  std::vector<model::HiddenMarkovModel::StatePtr> states;
+  for (unsigned int k = 0; k < state_alphabet_size; k++)
+    states.push_back(model::HiddenMarkovModel::State::make(
+      k,
+      generateRandomDistribution(observation_alphabet_size),
+      generateRandomDistribution(state_alphabet_size)));
+
+  return model::HiddenMarkovModel::make(
+    states,
+    generateRandomDistribution(state_alphabet_size),
+    state_alphabet_size,
+    observation_alphabet_size);
+}
+
+/*----------------------------------------------------------------------------*/
+
 model::HiddenMarkovModelPtr createDishonestCoinCasinoHMM() {
   std::vector<model::HiddenMarkovModel::StatePtr> states = {
     model::HiddenMarkovModel::State::make(
@@ -61,5 +93,34 @@ model::HiddenMarkovModelPtr createDishonestCoinCasinoHMM() {
 
 /*----------------------------------------------------------------------------*/
 
+model::HiddenMarkovModelPtr createCircularHMM(
+    unsigned int state_alphabet_size) {
+  double n = state_alphabet_size;
+
+  // Each state either stays or moves to the next one in the circle
+  std::vector<model::HiddenMarkovModel::StatePtr> states;
+  for (unsigned int k = 0; k < state_alphabet_size; k++) {
+    std::vector<model::Probability> transitions(state_alphabet_size);
+    transitions[k] = 0.6;
+    transitions[(k + 1) % state_alphabet_size] = 0.4;
+
+    states.push_back(model::HiddenMarkovModel::State::make(
+      k,
+      model::DiscreteIIDModel::make(
+        std::vector<model::Probability>{{ (k + 1) / (n + 1),
+                                          (n - k) / (n + 1) }}),
+      model::DiscreteIIDModel::make(transitions)));
+  }
+
+  return model::HiddenMarkovModel::make(
+    states,
+    model::DiscreteIIDModel::make(
+      std::vector<model::Probability>(state_alphabet_size, 1 / n)),
+    state_alphabet_size,
+    2);
+}
+
+/*----------------------------------------------------------------------------*/
+
 }  // namespace helper
 }  // namespace tops
@@ -0,0 +1,204 @@
+/***********************************************************************/
+/*  Copyright 2015 ToPS                                                */
+/*                                                                     */
+/*  This program is free software; you can redistribute it and/or      */
+/*  modify it under the terms of the GNU  General Public License as    */
+/*  published by the Free Software Foundation; either version 3 of     */
+/*  the License, or (at your option) any later version.                */
+/*                                                                     */
+/*  This program is distributed in the hope that it will be useful,    */
+/*  but WITHOUT ANY WARRANTY; without even the implied warranty of     */
+/*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the      */
+/*  GNU General Public License for more details.                       */
+/*                                                                     */
+/*  You should have received a copy of the GNU General Public License  */
+/*  along with this program; if not, write to the Free Software        */
+/*  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,         */
+/*  MA 02110-1301, USA.                                                */
+/***********************************************************************/
+
+// Interface header
+#include "model/ChunkedViterbi.hpp"
+
+// Standard headers
+#include <utility>
+#include <algorithm>
+
+// Internal headers
+#include "exception/OutOfRange.hpp"
+
+namespace tops {
+namespace model {
+
+/*----------------------------------------------------------------------------*/
+/*                               CONSTRUCTORS                                 */
+/*----------------------------------------------------------------------------*/
+
+ChunkedViterbi::ChunkedViterbi(GeneralizedHiddenMarkovModelPtr model,
+                               unsigned int chunk_size,
+                               unsigned int overlap,
+                               unsigned int number_of_threads)
+    : _model(std::move(model)), _chunk_size(std::max(1u, chunk_size)),
+      _overlap(overlap), _pool(ThreadPool::make(number_of_threads)) {
+  // A segment must fit in the context of a chunk to be decoded as a whole
+  for (unsigned int k = 0; k < _model->stateAlphabetSize(); k++)
+    if (_overlap < _model->maxDuration(k)) throw_exception(OutOfRange);
+}
+
+/*----------------------------------------------------------------------------*/
+/*                              STATIC METHODS                                */
+/*----------------------------------------------------------------------------*/
+
+ChunkedViterbiPtr ChunkedViterbi::make(GeneralizedHiddenMarkovModelPtr model,
+                                       unsigned int chunk_size,
+                                       unsigned int overlap,
+                                       unsigned int number_of_threads) {
+  return ChunkedViterbiPtr(new ChunkedViterbi(
+    std::move(model), chunk_size, overlap, number_of_threads));
+}
+
+/*----------------------------------------------------------------------------*/
+/*                             CONCRETE METHODS                               */
+/*----------------------------------------------------------------------------*/
+
+Estimation<Labeling<Sequence>>
+ChunkedViterbi::labeling(const Sequence& observation) {
+  _seams.clear();
+  _redecoded_windows = 0;
+
+  std::size_t length = observation.size();
+  if (length == 0) return Estimation<Labeling<Sequence>>();
+
+  // Each chunk is decoded with its context, in a window of its own
+  std::size_t number_of_chunks = (length + _chunk_size - 1) / _chunk_size;
+  std::vector<Window> windows(number_of_chunks);
+
+  _pool->parallelFor(number_of_chunks, [&] (std::size_t c, unsigned int) {
+    auto& window = windows[c];
+    window.limit = c * _chunk_size;
+    window.begin = window.limit > _overlap ? window.limit - _overlap : 0;
+    window.end = std::min(length, window.limit + _chunk_size + _overlap);
+    window.labels = decode(observation, window.begin, window.end);
+  });
+
+  // Two windows without an agreed boundary are joined and decoded again,
+  // which also asks for the seam before them to be found again
+  std::size_t first = 0;
+  for (std::size_t w = 0; w + 1 < windows.size(); ) {
+    std::size_t position;
+    if (stitch(windows[w], windows[w+1], first, position)) {
+      _seams.push_back({ position });
+      first = position;
+      w++;
+      continue;
+    }
+
+    windows[w].end = windows[w+1].end;
+    windows[w].labels = decode(observation, windows[w].begin, windows[w].end);
+    windows.erase(windows.begin() + w + 1);
+    _redecoded_windows++;
+
+    if (w > 0) {
+      _seams.pop_back();
+      first = _seams.empty() ? 0 : _seams.back().position;
+      w--;
+    }
+  }
+
+  Sequence path(length);
+  first = 0;
+  for (std::size_t w = 0; w < windows.size(); w++) {
+    std::size_t last = w < _seams.size() ? _seams[w].position : length;
+    for (auto i = first; i < last; i++)
+      path[i] = windows[w].labels[i - windows[w].begin];
+    first = last;
+  }
+
+  Labeling<Sequence> stitched(observation, std::move(path));
+  auto probability
+    = _model->labelingEvaluator(stitched)->evaluateSequence(0, length);
+  return Estimation<Labeling<Sequence>>(std::move(stitched), probability);
+}
+
+/*----------------------------------------------------------------------------*/
+
+const std::vector<ChunkedViterbi::Seam>& ChunkedViterbi::seams() const {
+  return _seams;
+}
+
+/*----------------------------------------------------------------------------*/
+
+unsigned int ChunkedViterbi::redecodedWindows() const {
+  return _redecoded_windows;
+}
+
+/*----------------------------------------------------------------------------*/
+
+std::vector<std::pair<std::size_t, std::size_t>>
+ChunkedViterbi::differences(const Labeling<Sequence>& stitched) const {
+  Sequence full = _model->labeler(stitched.observation())
+    ->labeling(Labeler::method::bestPath).estimated().label();
+
+  std::vector<std::pair<std::size_t, std::size_t>> ranges;
+  for (std::size_t i = 0; i < full.size(); i++) {
+    if (full[i] == stitched.label()[i]) continue;
+
+    if (!ranges.empty() && ranges.back().second == i)
+      ranges.back().second++;
+    else
+      ranges.emplace_back(i, i + 1);
+  }
+  return ranges;
+}
+
+/*----------------------------------------------------------------------------*/
+
+Sequence ChunkedViterbi::decode(const Sequence& observation,
+                                std::size_t begin, std::size_t end) const {
+  Sequence window(observation.begin() + begin, observation.begin() + end);
+  return _model->labeler(window)
+    ->labeling(Labeler::method::bestPath).estimated().label();
+}
+
+/*----------------------------------------------------------------------------*/
+
+bool ChunkedViterbi::stitch(const Window& left, const Window& right,
+                            std::size_t first, std::size_t& position) const {
+  // A boundary at p needs the labels at p-1 and p from both windows
+  std::size_t limit = right.limit;
+  std::size_t lowest = std::max(right.begin + 1, first);
+  std::size_t highest = left.end - 1;
+
+  auto agreed = [&] (std::size_t p) {
+    auto before = left.labels[p - 1 - left.begin];
+    auto after = left.labels[p - left.begin];
+    return before != after
+      && before == right.labels[p - 1 - right.begin]
+      && after == right.labels[p - right.begin];
+  };
+
+  // Boundaries closer to the limit have more context in both windows
+  if (lowest <= highest) {
+    auto reach = std::max(limit - std::min(limit, lowest),
+                          highest - std::min(highest, limit));
+    for (std::size_t delta = 0; delta <= reach; delta++) {
+      if (delta <= limit && limit - delta >= lowest
+            && limit - delta <= highest && agreed(limit - delta)) {
+        position = limit - delta;
+        return true;
+      }
+      if (limit + delta >= lowest && limit + delta <= highest
+            && agreed(limit + delta)) {
+        position = limit + delta;
+        return true;
+      }
+    }
+  }
+
+  return false;
+}
+
+/*----------------------------------------------------------------------------*/
+
+}  // namespace model
+}  // namespace tops
@@ -37,7 +37,18 @@ namespace model {
 
 ExplicitDuration::ExplicitDuration(ProbabilisticModelPtr duration,
                                    unsigned int max_duration_size)
-    : _duration(std::move(duration)), _max_duration_size(max_duration_size) {
+    : _duration(std::move(duration)), _max_duration_size(max_duration_size),
+      _probabilities(max_duration_size + 1),
+      _survivals(max_duration_size + 2, Probability(0)) {
+  for (unsigned int length = 0; length <= _max_duration_size; length++)
+    _probabilities[length]
+      = _duration->standardEvaluator(Sequence{length})->evaluateSymbol(0);
+
+  for (unsigned int length = _max_duration_size + 1; length-- > 0; )
+    _survivals[length] = _survivals[length + 1] + _probabilities[length];
+
+  for (unsigned int length = 1; length <= _max_duration_size; length++)
+    if (Probability(0) < _probabilities[length]) _support.push_back(length);
 }
 
 /*----------------------------------------------------------------------------*/
@@ -50,6 +61,12 @@ RangePtr ExplicitDuration::range() const {
 
 /*----------------------------------------------------------------------------*/
 
+DurationSupport ExplicitDuration::support() const {
+  return DurationSupport(_support);
+}
+
+/*----------------------------------------------------------------------------*/
+
 unsigned int ExplicitDuration::maximumSize() const {
   return 0;
 }
@@ -58,10 +75,18 @@ unsigned int ExplicitDuration::maximumSize() const {
 
 Probability
 ExplicitDuration::probabilityOfLenght(unsigned int length) const {
+  if (length < _probabilities.size()) return _probabilities[length];
   return _duration->standardEvaluator(Sequence{length})->evaluateSymbol(0);
 }
 
 /*----------------------------------------------------------------------------*/
 
+Probability ExplicitDuration::survival(unsigned int length) const {
+  if (length < _survivals.size()) return _survivals[length];
+  return 0;
+}
+
+/*----------------------------------------------------------------------------*/
+
 }  // namespace model
 }  // namespace tops
@@ -22,7 +22,9 @@
 
 // Standard headers
 #include <cmath>
+#include <cstdint>
 #include <limits>
+#include <numeric>
 #include <vector>
 #include <utility>
 #include <algorithm>
@@ -30,6 +32,9 @@
 // Internal headers
 #include "model/Util.hpp"
 #include "model/Segment.hpp"
+#include "model/ThreadPool.hpp"
+#include "model/ExplicitDuration.hpp"
+#include "model/GeometricDuration.hpp"
 
 #include "exception/NotYetImplemented.hpp"
 
@@ -51,6 +56,56 @@ GeneralizedHiddenMarkovModel::GeneralizedHiddenMarkovModel(
       _max_backtracking(max_backtracking) {
 }
 
+/*----------------------------------------------------------------------------*/
+/*                              STATIC METHODS                                */
+/*----------------------------------------------------------------------------*/
+
+GeneralizedHiddenMarkovModelPtr
+GeneralizedHiddenMarkovModel::train(
+    TrainerPtr<Standard, Self> trainer,
+    viterbi_training_algorithm,
+    GeneralizedHiddenMarkovModelPtr initial_model,
+    unsigned int max_iterations,
+    double diff_threshold,
+    unsigned int number_of_threads) {
+  auto& observation_training_set = trainer->training_set();
+
+  auto model = GeneralizedHiddenMarkovModel::make(*initial_model);
+  if (observation_training_set.empty()) return model;
+
+  auto pool = ThreadPool::make(number_of_threads);
+
+  // One block of contiguous sequences per worker, merged in a fixed order
+  std::vector<std::size_t> lengths;
+  for (const auto& training_sequence : observation_training_set)
+    lengths.push_back(training_sequence.size());
+
+  auto limits = ThreadPool::partition(lengths, pool->size());
+  std::vector<SegmentCounts> counts(limits.size() - 1);
+
+  double last = 0;
+  for (unsigned int iteration = 0; iteration < max_iterations; iteration++) {
+    pool->parallelFor(counts.size(), [&](std::size_t block, unsigned int) {
+      model->resetSegmentCounts(counts[block]);
+      for (auto s = limits[block]; s < limits[block+1]; s++)
+        model->accumulateSegmentCounts(
+          observation_training_set[s], counts[block]);
+    });
+
+    for (std::size_t block = 1; block < counts.size(); block++)
+      mergeSegmentCounts(counts[0], counts[block]);
+
+    model = model->maximizeSegmentCounts(counts[0]);
+
+    auto diff = std::fabs(last - counts[0].likelihood.data());
+    last = counts[0].likelihood.data();
+
+    if (diff < diff_threshold) break;
+  }
+
+  return model;
+}
+
 /*----------------------------------------------------------------------------*/
 /*                             OVERRIDEN METHODS                              */
 /*                           (Probabilistic Model)                            */
@@ -147,22 +202,10 @@ GeneralizedHiddenMarkovModel::evaluateSequence(SEPtr<Labeling> evaluator,
                                                unsigned int /* begin */,
                                                unsigned int /* end */,
                                                unsigned int /* phase */) const {
-  Probability prob = 1;
-  auto segments = Segment::readSequence(evaluator->sequence().label());
-  for (unsigned int i = 0; i < segments.size(); i++) {
-    if (i == 0) {
-      prob *= _initial_probabilities->probabilityOf(segments[i].symbol());
-    } else {
-      prob *= _states[segments[i-1].symbol()]->transition()->probabilityOf(
-        segments[i].symbol());
-    }
-    prob *= _states[segments[i].symbol()]->duration()->probabilityOfLenght(
-      segments[i].end() - segments[i].begin());
-    prob *= _states[segments[i].symbol()]->emission()->standardEvaluator(
-      evaluator->sequence().observation())->evaluateSequence(
-        segments[i].begin(), segments[i].end());
-  }
-  return prob;
+  auto observation_evaluators = initializeObservationEvaluators(
+    evaluator->sequence().observation(), false);
+  return pathProbability(evaluator->sequence().label(),
+                         observation_evaluators);
 }
 
 /*----------------------------------------------------------------------------*/
@@ -218,6 +261,7 @@ GeneralizedHiddenMarkovModel::labeling(CLPtr labeler,
                                        const Labeler::method& method) const {
   switch (method) {
     case Labeler::method::bestPath:
+    case Labeler::method::vectorizedBestPath:
       return viterbi(labeler->sequence(), labeler->cache().gamma,
                      labeler->cache().observation_evaluators);
     case Labeler::method::posteriorDecoding:
@@ -229,9 +273,52 @@ GeneralizedHiddenMarkovModel::labeling(CLPtr labeler,
 
 /*----------------------------------------------------------------------------*/
 
+Estimation<Labeling<Sequence>>
+GeneralizedHiddenMarkovModel::labeling(CLPtr labeler, Beam& beam) const {
+  return beamViterbi(labeler->sequence(), beam,
+                     labeler->cache().observation_evaluators);
+}
+
+/*----------------------------------------------------------------------------*/
+
+Estimation<Labeling<Sequence>>
+GeneralizedHiddenMarkovModel::labeling(CLPtr labeler,
+                                       Posteriors& posteriors) const {
+  return fusedPosteriorDecoding(labeler->sequence(), posteriors,
+                                labeler->cache().observation_evaluators);
+}
+
+/*----------------------------------------------------------------------------*/
+
+Estimation<Labeling<Sequence>>
+GeneralizedHiddenMarkovModel::labeling(CLPtr labeler, NBest& nbest) const {
+  return listViterbi(labeler->sequence(), nbest,
+                     labeler->cache().observation_evaluators);
+}
+
+/*----------------------------------------------------------------------------*/
+
+std::vector<Estimation<Labeling<Sequence>>>
+GeneralizedHiddenMarkovModel::sampling(CLPtr labeler,
+                                       unsigned int number_of_samples,
+                                       RandomNumberGeneratorPtr rng,
+                                       unsigned int number_of_threads) const {
+  auto& cache = labeler->cache();
+  if (!cache.filled_alpha) {
+    forward(labeler->sequence(), cache.alpha, cache.observation_evaluators);
+    cache.filled_alpha = true;
+  }
+  return stochasticTraceback(labeler->sequence(), cache.alpha,
+                             cache.observation_evaluators,
+                             number_of_samples, rng, number_of_threads);
+}
+
+/*----------------------------------------------------------------------------*/
+
 void GeneralizedHiddenMarkovModel::initializeCache(CLPtr labeler) {
   labeler->cache().observation_evaluators
     = initializeObservationEvaluators(labeler->sequence(), true);
+  labeler->cache().filled_alpha = false;
 }
 
 /*----------------------------------------------------------------------------*/
@@ -245,6 +332,7 @@ GeneralizedHiddenMarkovModel::labeling(SLPtr labeler,
 
   switch (method) {
     case Labeler::method::bestPath:
+    case Labeler::method::vectorizedBestPath:
       return viterbi(labeler->sequence(), probabilities,
                      observation_evaluators);
     case Labeler::method::posteriorDecoding:
@@ -253,6 +341,51 @@ GeneralizedHiddenMarkovModel::labeling(SLPtr labeler,
   return Estimation<Labeling<Sequence>>();
 }
 
+/*----------------------------------------------------------------------------*/
+
+Estimation<Labeling<Sequence>>
+GeneralizedHiddenMarkovModel::labeling(SLPtr labeler, Beam& beam) const {
+  auto observation_evaluators
+    = initializeObservationEvaluators(labeler->sequence(), false);
+  return beamViterbi(labeler->sequence(), beam, observation_evaluators);
+}
+
+/*----------------------------------------------------------------------------*/
+
+Estimation<Labeling<Sequence>>
+GeneralizedHiddenMarkovModel::labeling(SLPtr labeler,
+                                       Posteriors& posteriors) const {
+  auto observation_evaluators
+    = initializeObservationEvaluators(labeler->sequence(), false);
+  return fusedPosteriorDecoding(labeler->sequence(), posteriors,
+                                observation_evaluators);
+}
+
+/*----------------------------------------------------------------------------*/
+
+Estimation<Labeling<Sequence>>
+GeneralizedHiddenMarkovModel::labeling(SLPtr labeler, NBest& nbest) const {
+  auto observation_evaluators
+    = initializeObservationEvaluators(labeler->sequence(), false);
+  return listViterbi(labeler->sequence(), nbest, observation_evaluators);
+}
+
+/*----------------------------------------------------------------------------*/
+
+std::vector<Estimation<Labeling<Sequence>>>
+GeneralizedHiddenMarkovModel::sampling(SLPtr labeler,
+                                       unsigned int number_of_samples,
+                                       RandomNumberGeneratorPtr rng,
+                                       unsigned int number_of_threads) const {
+  Matrix alpha;
+  auto observation_evaluators
+    = initializeObservationEvaluators(labeler->sequence(), false);
+  forward(labeler->sequence(), alpha, observation_evaluators);
+  return stochasticTraceback(labeler->sequence(), alpha,
+                             observation_evaluators,
+                             number_of_samples, rng, number_of_threads);
+}
+
 /*==============================  CALCULATOR  ================================*/
 
 Probability GeneralizedHiddenMarkovModel::calculate(
@@ -303,8 +436,7 @@ Probability GeneralizedHiddenMarkovModel::calculate(
 void GeneralizedHiddenMarkovModel::posteriorProbabilities(
     const Sequence& sequence,
     Matrix& probabilities) const {
-  probabilities
-    = Matrix(_state_alphabet_size, std::vector<Probability>(sequence.size()));
+  probabilities.reset(_state_alphabet_size, sequence.size());
 
   Matrix alpha;  // forward
   Matrix beta;   // backward
@@ -317,51 +449,341 @@ void GeneralizedHiddenMarkovModel::posteriorProbabilities(
 
   for (unsigned int k = 0; k < _state_alphabet_size; k++)
     for (unsigned int i = 0; i < sequence.size(); i++)
-      probabilities[k][i] = (alpha[k][i] * beta[k][i]) / full;
+      probabilities(k, i) = (alpha(k, i) * beta(k, i)) / full;
 }
 
 /*----------------------------------------------------------------------------*/
 /*                              CONCRETE METHODS                              */
 /*----------------------------------------------------------------------------*/
 
+Probability GeneralizedHiddenMarkovModel::pathProbability(
+    const Sequence& ys,
+    std::vector<EvaluatorPtr<Standard>>& observation_evaluators) const {
+  Probability prob = 1;
+  auto segments = Segment::readSequence(ys);
+  for (unsigned int i = 0; i < segments.size(); i++) {
+    if (i == 0) {
+      prob *= _initial_probabilities->probabilityOf(segments[i].symbol());
+    } else {
+      prob *= _states[segments[i-1].symbol()]->transition()->probabilityOf(
+        segments[i].symbol());
+    }
+    prob *= _states[segments[i].symbol()]->duration()->probabilityOfLenght(
+      segments[i].end() - segments[i].begin());
+    prob *= observation_evaluators[segments[i].symbol()]->evaluateSequence(
+      segments[i].begin(), segments[i].end());
+  }
+  return prob;
+}
+
+/*----------------------------------------------------------------------------*/
+
+std::vector<DurationSupport>
+GeneralizedHiddenMarkovModel::durationSupports() const {
+  std::vector<DurationSupport> supports(_state_alphabet_size);
+  for (unsigned int k = 0; k < _state_alphabet_size; k++)
+    supports[k] = _states[k]->duration()->support().upTo(maxDuration(k));
+  return supports;
+}
+
+/*----------------------------------------------------------------------------*/
+
+std::vector<char> GeneralizedHiddenMarkovModel::geometricStates() const {
+  std::vector<char> geometric(_state_alphabet_size);
+  for (unsigned int k = 0; k < _state_alphabet_size; k++)
+    geometric[k] = _states[k]->consensus().empty()
+      && std::dynamic_pointer_cast<GeometricDuration>(
+           _states[k]->duration()) != nullptr;
+  return geometric;
+}
+
+/*----------------------------------------------------------------------------*/
+
+GeneralizedHiddenMarkovModel::CandidateSites
+GeneralizedHiddenMarkovModel::candidateSites(const Sequence& sequence) const {
+  CandidateSites candidates;
+  candidates.constrained.resize(_state_alphabet_size);
+  candidates.begins.resize(_state_alphabet_size);
+
+  for (unsigned int k = 0; k < _state_alphabet_size; k++) {
+    if (_states[k]->consensus().empty()) continue;
+
+    candidates.constrained[k] = true;
+    auto& begins = candidates.begins[k];
+    begins.resize(sequence.size());
+    for (unsigned int begin = 0; begin < sequence.size(); begin++)
+      begins[begin] = _states[k]->admitsSegmentAt(sequence, begin);
+  }
+
+  return candidates;
+}
+
+/*----------------------------------------------------------------------------*/
+
+std::vector<std::size_t> GeneralizedHiddenMarkovModel::columnBlocks(
+    const std::vector<DurationSupport>& supports,
+    std::unique_lock<std::mutex>& lock) const {
+  std::vector<std::size_t> blocks = { 0, _state_alphabet_size };
+  if (!_column_pool || _column_pool->threads->size() == 1) return blocks;
+
+  // Another algorithm is using the threads: run sequentially
+  lock = std::unique_lock<std::mutex>(_column_pool->mutex, std::try_to_lock);
+  if (!lock.owns_lock()) return blocks;
+
+  // A cell evaluates one emission window per length of the support, and
+  // the cost of a window grows at most with its length
+  std::vector<std::size_t> costs(_state_alphabet_size, 0);
+  for (unsigned int k = 0; k < _state_alphabet_size; k++)
+    for (auto d : supports[k]) costs[k] += d;
+
+  return ThreadPool::partition(costs, _column_pool->threads->size());
+}
+
+/*----------------------------------------------------------------------------*/
+
+template<typename Cell>
+void GeneralizedHiddenMarkovModel::computeColumn(
+    const std::vector<std::size_t>& blocks, const Cell& cell) const {
+  if (blocks.size() <= 2) {
+    for (unsigned int k = 0; k < _state_alphabet_size; k++) cell(k);
+    return;
+  }
+
+  _column_pool->threads->parallelFor(
+    blocks.size() - 1, [&] (std::size_t block, unsigned int) {
+      for (auto k = blocks[block]; k < blocks[block+1]; k++)
+        cell(static_cast<unsigned int>(k));
+    });
+}
+
+/*----------------------------------------------------------------------------*/
+
+void GeneralizedHiddenMarkovModel::parallelizeColumns(
+    unsigned int number_of_threads) {
+  _column_pool = std::make_shared<ColumnPool>();
+  _column_pool->threads = ThreadPool::make(number_of_threads);
+}
+
+/*----------------------------------------------------------------------------*/
+
+unsigned int GeneralizedHiddenMarkovModel::maxDuration(
+    unsigned int state) const {
+  auto size = _states[state]->duration()->maximumSize();
+  return size > 0 ? size : _max_backtracking;
+}
+
+/*----------------------------------------------------------------------------*/
+
+std::vector<Segment> GeneralizedHiddenMarkovModel::saturatedSegments(
+    const Sequence& label) const {
+  std::vector<Segment> saturated;
+  for (auto segment : Segment::readSequence(label)) {
+    if (_states[segment.symbol()]->duration()->maximumSize() > 0) continue;
+
+    auto length = static_cast<unsigned int>(segment.end() - segment.begin());
+    if (length >= _max_backtracking) saturated.push_back(segment);
+  }
+  return saturated;
+}
+
+/*----------------------------------------------------------------------------*/
+
 Estimation<Labeling<Sequence>> GeneralizedHiddenMarkovModel::viterbi(
       const Sequence& xs,
       Matrix& gamma,
+      std::vector<EvaluatorPtr<Standard>>& observation_evaluators,
+      std::vector<Segment>* segments) const {
+  gamma.reset(_state_alphabet_size, xs.size());
+
+  IndexMatrix psi(_state_alphabet_size, xs.size());
+  IndexMatrix psilen(_state_alphabet_size, xs.size());
+  auto supports = durationSupports();
+  auto geometric = geometricStates();
+  auto candidates = candidateSites(xs);
+
+  // Best entry into each state from the segments ending at each position
+  Matrix entries(_state_alphabet_size, xs.size());
+  IndexMatrix entry_states(_state_alphabet_size, xs.size());
+
+  std::unique_lock<std::mutex> lock;
+  auto blocks = columnBlocks(supports, lock);
+
+  for (size_t i = 0; i < xs.size(); i++) {
+    computeColumn(blocks, [&] (unsigned int k) {
+      auto initial = _initial_probabilities->probabilityOf(k);
+      if (geometric[k]) {
+        gamma(k, i) = (i == 0 ? initial : entries(k, i-1))
+          * observation_evaluators[k]->evaluateSequence(i, i+1);
+        psi(k, i) = (i == 0 ? 0 : entry_states(k, i-1));
+        psilen(k, i) = 1;
+        return;
+      }
+
+      auto duration = _states[k]->duration();
+      for (auto d : supports[k].upTo(i+1)) {
+        if (!candidates.admits(k, i-d+1)) continue;
+
+        Probability gmax = initial;
+        size_t pmax = 0;
+        if (d <= i) {
+          gmax = entries(k, i-d);
+          pmax = entry_states(k, i-d);
+        }
+
+        gmax *= duration->probabilityOfLenght(d)
+          * observation_evaluators[k]->evaluateSequence(i-d+1, i+1);
+        if (gamma(k, i) < gmax) {
+          gamma(k, i) = gmax;
+          psi(k, i) = pmax;
+          psilen(k, i) = d;
+        }
+      }
+    });
+
+    viterbiEntries(gamma, i, entries, entry_states);
+  }
+
+  Probability max = 0;
+  Symbol state = 0;
+  size_t L = xs.size() - 1;
+
+  for (size_t k = 0; k < _state_alphabet_size; k++) {
+    if (max < gamma(k, L)) {
+      state = k;
+      max = gamma(k, L);
+    }
+  }
+
+  Sequence path = Sequence(xs.size());
+
+  // Segments of the traceback, which may repeat a state (unlike the runs
+  // of labels of the path)
+  if (segments) segments->clear();
+
+  unsigned int i = 0;
+  while (i <= L) {
+    unsigned int d = psilen(state, L-i);
+    unsigned int p = psi(state, L-i);
+    if (segments) {
+      int end = static_cast<int>(L - i + 1);
+      segments->emplace_back(state, end - static_cast<int>(d), end);
+    }
+    for (unsigned int j = 0; j < d; j++) {
+      path[L-i] = state;
+      i++;
+    }
+    state = p;
+  }
+  if (segments) std::reverse(segments->begin(), segments->end());
+
+  return Estimation<Labeling<Sequence>>(
+      Labeling<Sequence>(xs, std::move(path)), max);
+}
+
+/*----------------------------------------------------------------------------*/
+
+Estimation<Labeling<Sequence>> GeneralizedHiddenMarkovModel::beamViterbi(
+      const Sequence& xs,
+      Beam& beam,
       std::vector<EvaluatorPtr<Standard>>& observation_evaluators) const {
-  gamma = Matrix(_state_alphabet_size, std::vector<Probability>(xs.size()));
+  Matrix gamma(_state_alphabet_size, xs.size());
+
+  IndexMatrix psi(_state_alphabet_size, xs.size());
+  IndexMatrix psilen(_state_alphabet_size, xs.size());
+  auto supports = durationSupports();
+  auto geometric = geometricStates();
+  auto candidates = candidateSites(xs);
+
+  // Ratio to the maximum of the column below which states are pruned
+  double threshold = std::exp(-beam.margin);
+
+  beam.cells = 0;
+  beam.pruned_cells = 0;
+  beam.score_loss_bound = 0;
+
+  std::vector<unsigned int> kept;
 
-  using IndexMatrix = std::vector<std::vector<size_t>>;
-  IndexMatrix psi(_state_alphabet_size, std::vector<size_t>(xs.size()));
-  IndexMatrix psilen(_state_alphabet_size, std::vector<size_t>(xs.size()));
+  // Best pruned segment end of each position (for score_loss_bound)
+  std::vector<Probability> best_pruned(xs.size(), 0);
+
+  // Best entry into each state from the segments ending at each position
+  Matrix entries(_state_alphabet_size, xs.size());
+  IndexMatrix entry_states(_state_alphabet_size, xs.size());
+
+  std::unique_lock<std::mutex> lock;
+  auto blocks = columnBlocks(supports, lock);
 
   for (size_t i = 0; i < xs.size(); i++) {
-    for (size_t k = 0; k < _state_alphabet_size; k++) {
-      auto range = _states[k]->duration()->range();
-      for (auto d=range->begin(); !range->end() && d <= i+1; d=range->next()) {
-        Probability gmax = 0;
+    computeColumn(blocks, [&] (unsigned int k) {
+      auto initial = _initial_probabilities->probabilityOf(k);
+      if (geometric[k]) {
+        gamma(k, i) = (i == 0 ? initial : entries(k, i-1))
+          * observation_evaluators[k]->evaluateSequence(i, i+1);
+        psi(k, i) = (i == 0 ? 0 : entry_states(k, i-1));
+        psilen(k, i) = 1;
+        return;
+      }
+
+      auto duration = _states[k]->duration();
+      for (auto d : supports[k].upTo(i+1)) {
+        if (!candidates.admits(k, i-d+1)) continue;
+
+        Probability gmax = initial;
         size_t pmax = 0;
-        if (d > i) {
-          gmax = _initial_probabilities->probabilityOf(k);
-        } else {
-          for (auto p : _states[k]->predecessors()) {
-            Probability g = gamma[p][i-d]
-              * _states[p]->transition()->probabilityOf(k);
-            if (gmax < g) {
-              gmax = g;
-              pmax = p;
-            }
-          }
+        if (d <= i) {
+          gmax = entries(k, i-d);
+          pmax = entry_states(k, i-d);
         }
 
-        gmax *= _states[k]->duration()->probabilityOfLenght(d)
+        gmax *= duration->probabilityOfLenght(d)
           * observation_evaluators[k]->evaluateSequence(i-d+1, i+1);
-        if (gamma[k][i] < gmax) {
-          gamma[k][i] = gmax;
-          psi[k][i] = pmax;
-          psilen[k][i] = d;
+        if (gamma(k, i) < gmax) {
+          gamma(k, i) = gmax;
+          psi(k, i) = pmax;
+          psilen(k, i) = d;
         }
       }
+    });
+
+    // Prune the column
+    Probability column_max = 0;
+    for (size_t k = 0; k < _state_alphabet_size; k++)
+      if (column_max < gamma(k, i)) column_max = gamma(k, i);
+
+    // Unreachable states are not extended by the exact algorithm either
+    std::size_t reachable = 0;
+    kept.clear();
+    for (unsigned int k = 0; k < _state_alphabet_size; k++) {
+      if (!(Probability(0) < gamma(k, i))) continue;
+      reachable++;
+      if (static_cast<double>(gamma(k, i) / column_max) >= threshold)
+        kept.push_back(k);
+    }
+
+    if (beam.width != 0 && kept.size() > beam.width) {
+      std::nth_element(kept.begin(), kept.begin() + beam.width - 1,
+                       kept.end(),
+                       [&] (unsigned int a, unsigned int b) {
+                         return gamma(b, i) < gamma(a, i);
+                       });
+      kept.resize(beam.width);
+      std::sort(kept.begin(), kept.end());
+    }
+
+    for (unsigned int k = 0, c = 0; k < _state_alphabet_size; k++) {
+      if (c < kept.size() && kept[c] == k) {
+        c++;
+      } else {
+        if (best_pruned[i] < gamma(k, i)) best_pruned[i] = gamma(k, i);
+        gamma(k, i) = 0;
+      }
     }
+
+    beam.cells += reachable;
+    beam.pruned_cells += reachable - kept.size();
+
+    // Pruned states were zeroed, and are never the best entry
+    viterbiEntries(gamma, i, entries, entry_states);
   }
 
   Probability max = 0;
@@ -369,18 +791,39 @@ Estimation<Labeling<Sequence>> GeneralizedHiddenMarkovModel::viterbi(
   size_t L = xs.size() - 1;
 
   for (size_t k = 0; k < _state_alphabet_size; k++) {
-    if (max < gamma[k][L]) {
+    if (max < gamma(k, L)) {
       state = k;
-      max = gamma[k][L];
+      max = gamma(k, L);
+    }
+  }
+
+  if (beam.bounded) {
+    // Up to its first pruned segment end, the best path is kept, and its
+    // score there is at most the best pruned cell. Durations and emissions
+    // of the remaining segments are at most 1, and at least one transition
+    // follows any segment that does not end the sequence
+    Probability best_transition = 0;
+    for (unsigned int k = 0; k < _state_alphabet_size; k++)
+      for (auto p : _states[k]->predecessors())
+        if (best_transition < _states[p]->transition()->probabilityOf(k))
+          best_transition = _states[p]->transition()->probabilityOf(k);
+
+    Probability bound = max;
+    for (size_t i = 0; i <= L; i++) {
+      Probability completed = best_pruned[i]
+        * (i == L ? Probability(1) : best_transition);
+      if (bound < completed) bound = completed;
     }
+
+    beam.score_loss_bound = std::log(static_cast<double>(bound / max));
   }
 
   Sequence path = Sequence(xs.size());
 
   unsigned int i = 0;
   while (i <= L) {
-    unsigned int d = psilen[state][L-i];
-    unsigned int p = psi[state][L-i];
+    unsigned int d = psilen(state, L-i);
+    unsigned int p = psi(state, L-i);
     for (unsigned int j = 0; j < d; j++) {
       path[L-i] = state;
       i++;
@@ -394,6 +837,212 @@ Estimation<Labeling<Sequence>> GeneralizedHiddenMarkovModel::viterbi(
 
 /*----------------------------------------------------------------------------*/
 
+Estimation<Labeling<Sequence>> GeneralizedHiddenMarkovModel::listViterbi(
+      const Sequence& xs,
+      NBest& nbest,
+      std::vector<EvaluatorPtr<Standard>>& observation_evaluators) const {
+  if (nbest.lazy) throw_exception(NotYetImplemented);
+
+  nbest.labelings.clear();
+
+  unsigned int length = xs.size();
+  if (length == 0) return Estimation<Labeling<Sequence>>();
+
+  unsigned int n = _state_alphabet_size;
+  unsigned int size = std::max(1u, nbest.size);
+  auto supports = durationSupports();
+  auto candidates = candidateSites(xs);
+
+  unsigned int max_duration = 1;
+  for (const auto& support : supports)
+    max_duration = std::max(max_duration, support.last());
+
+  // Path r of the segments of state k ending at i is kept in row
+  // k * size + r, and points to the path q of its predecessor p as
+  // p * size + q (or n * size, when the segment starts the sequence).
+  // Only the back pointers span the whole sequence: a cell reads the
+  // scores of the columns up to the longest duration behind it, so only
+  // that many are kept, in a ring
+  unsigned int columns = std::min(max_duration + 1, length);
+  Matrix scores(n * size, columns);
+  IndexMatrix counts(n, columns);
+  IndexMatrix psi(n * size, length);
+  IndexMatrix psilen(n * size, length);
+
+  // Different segmentations may give the same labels (when a state
+  // follows itself), so each path also keeps a polynomial hash of its
+  // labels: a cell refuses the paths whose labels it already has, and
+  // keeps its `size` best distinct labelings instead of segmentations.
+  // Equal hashes are confirmed by comparing the labels of both paths
+  const std::uint64_t base = 0x100000001b3;
+  std::vector<std::uint64_t> powers(max_duration + 1, 1);
+  std::vector<std::uint64_t> repeats(max_duration + 1, 0);
+  for (unsigned int d = 1; d <= max_duration; d++) {
+    powers[d] = powers[d-1] * base;
+    repeats[d] = repeats[d-1] * base + 1;
+  }
+  BasicMatrix<std::uint64_t> hashes(n * size, columns);
+
+  // Last segment of a path: its state, its begin and the path it extends
+  // (packed as in psi)
+  struct Cursor {
+    unsigned int state;
+    unsigned int begin;
+    unsigned int predecessor;
+  };
+
+  auto previous = [&](Cursor& cursor) {
+    auto row = cursor.predecessor, end = cursor.begin;
+    cursor = { row / size, end - psilen(row, end - 1), psi(row, end - 1) };
+  };
+
+  // Walks back two paths ending at the same position, always in the
+  // segment that begins later. Paths extending the same path from the
+  // same position have the same labels from there on
+  auto sameLabels = [&](Cursor a, Cursor b) {
+    while (a.state == b.state) {
+      if (a.begin == b.begin) {
+        if (a.begin == 0 || a.predecessor == b.predecessor) return true;
+        previous(a);
+        previous(b);
+      } else if (a.begin > b.begin) {
+        previous(a);
+      } else {
+        previous(b);
+      }
+    }
+    return false;
+  };
+
+  struct Candidate {
+    Probability score;       // of the path extended by the segment
+    Probability extension;   // transition, duration and emissions
+    unsigned int state;      // predecessor
+    unsigned int rank;       // of the predecessor's path
+    unsigned int duration;   // of the segment
+
+    bool operator<(const Candidate& other) const {
+      return score < other.score;
+    }
+  };
+  std::vector<Candidate> heap;
+
+  for (unsigned int i = 0; i < length; i++) {
+    unsigned int column = i % columns;
+    for (unsigned int k = 0; k < n; k++) {
+      heap.clear();
+
+      auto duration = _states[k]->duration();
+      for (auto d : supports[k].upTo(i+1)) {
+        if (!candidates.admits(k, i-d+1)) continue;
+
+        Probability segment = duration->probabilityOfLenght(d)
+          * observation_evaluators[k]->evaluateSequence(i-d+1, i+1);
+        if (!(Probability(0) < segment)) continue;
+
+        if (d > i) {
+          Probability extension
+            = _initial_probabilities->probabilityOf(k) * segment;
+          heap.push_back({ extension, extension, n, 0, d });
+        } else {
+          for (auto p : _states[k]->predecessors()) {
+            if (counts(p, (i-d) % columns) == 0) continue;
+            Probability extension
+              = _states[p]->transition()->probabilityOf(k) * segment;
+            heap.push_back({ scores(p * size, (i-d) % columns) * extension,
+                             extension, p, 0, d });
+          }
+        }
+      }
+      std::make_heap(heap.begin(), heap.end());
+
+      unsigned int r = 0;
+      while (r < size && !heap.empty()) {
+        std::pop_heap(heap.begin(), heap.end());
+        auto best = heap.back();
+        heap.pop_back();
+        if (!(Probability(0) < best.score)) break;
+
+        auto begin = i - best.duration + 1;
+        std::uint64_t hash = repeats[best.duration] * (k + 1);
+        if (best.state < n) {
+          hash += powers[best.duration] * hashes(
+            best.state * size + best.rank, (begin - 1) % columns);
+        }
+
+        Cursor path = { k, begin, best.state * size + best.rank };
+
+        bool repeated = false;
+        for (unsigned int q = 0; q < r && !repeated; q++) {
+          auto row = k * size + q;
+          repeated = hashes(row, column) == hash
+            && sameLabels(path, { k, i + 1 - psilen(row, i), psi(row, i) });
+        }
+
+        if (!repeated) {
+          scores(k * size + r, column) = best.score;
+          hashes(k * size + r, column) = hash;
+          psi(k * size + r, i) = best.state * size + best.rank;
+          psilen(k * size + r, i) = best.duration;
+          r++;
+        }
+
+        if (best.state < n
+            && best.rank + 1 < counts(best.state, (begin - 1) % columns)) {
+          heap.push_back({
+            scores(best.state * size + best.rank + 1, (begin - 1) % columns)
+              * best.extension,
+            best.extension, best.state, best.rank + 1, best.duration });
+          std::push_heap(heap.begin(), heap.end());
+        }
+      }
+      counts(k, column) = r;
+    }
+  }
+
+  unsigned int last = length - 1;
+
+  // Paths ending at different states have different labels, and the
+  // paths of a state were made distinct when its cell was filled
+  heap.clear();
+  for (unsigned int k = 0; k < n; k++)
+    if (counts(k, last % columns) > 0)
+      heap.push_back({ scores(k * size, last % columns), 1, k, 0, 0 });
+  std::make_heap(heap.begin(), heap.end());
+
+  while (nbest.labelings.size() < size && !heap.empty()) {
+    std::pop_heap(heap.begin(), heap.end());
+    auto best = heap.back();
+    heap.pop_back();
+
+    Sequence ys(length);
+    unsigned int k = best.state, r = best.rank;
+    for (unsigned int end = length; end > 0; ) {
+      auto packed = psi(k * size + r, end - 1);
+      auto begin = end - psilen(k * size + r, end - 1);
+      for (unsigned int i = begin; i < end; i++) ys[i] = k;
+      k = packed / size;
+      r = packed % size;
+      end = begin;
+    }
+
+    nbest.labelings.emplace_back(
+      Labeling<Sequence>(xs, std::move(ys)), best.score);
+
+    if (best.rank + 1 < counts(best.state, last % columns)) {
+      heap.push_back({
+        scores(best.state * size + best.rank + 1, last % columns),
+        1, best.state, best.rank + 1, 0 });
+      std::push_heap(heap.begin(), heap.end());
+    }
+  }
+
+  if (nbest.labelings.empty()) return Estimation<Labeling<Sequence>>();
+  return nbest.labelings.front();
+}
+
+/*----------------------------------------------------------------------------*/
+
 Estimation<Labeling<Sequence>>
 GeneralizedHiddenMarkovModel::posteriorDecoding(const Sequence& xs,
                                                 Matrix& probabilities) const {
@@ -402,11 +1051,11 @@ GeneralizedHiddenMarkovModel::posteriorDecoding(const Sequence& xs,
   Sequence path(xs.size());
 
   for (unsigned int i = 0; i < xs.size(); i++) {
-    Probability max = probabilities[0][i];
+    Probability max = probabilities(0, i);
     path[i] = 0;
     for (unsigned int k = 1; k < _state_alphabet_size; k++) {
-      if (probabilities[k][i] > max) {
-        max = probabilities[k][i];
+      if (probabilities(k, i) > max) {
+        max = probabilities(k, i);
         path[i] = k;
       }
     }
@@ -419,36 +1068,182 @@ GeneralizedHiddenMarkovModel::posteriorDecoding(const Sequence& xs,
 
 /*----------------------------------------------------------------------------*/
 
-Probability GeneralizedHiddenMarkovModel::forward(
-    const Sequence& seq, Matrix& alpha,
+Estimation<Labeling<Sequence>>
+GeneralizedHiddenMarkovModel::fusedPosteriorDecoding(
+    const Sequence& xs,
+    Posteriors& posteriors,
     std::vector<EvaluatorPtr<Standard>>& observation_evaluators) const {
-  alpha = Matrix(_state_alphabet_size, std::vector<Probability>(seq.size()));
+  unsigned int length = xs.size();
 
-  for (unsigned int i = 0; i < seq.size(); i++) {
-    for (unsigned int k = 0; k < _state_alphabet_size; k++) {
-      auto range = _states[k]->duration()->range();
-      for (unsigned int d = range->begin();
-           !range->end() && d <= (i + 1);
-           d = range->next()) {
-        if (d > i) {
-          alpha[k][i] += _initial_probabilities->probabilityOf(k)
-            * _states[k]->duration()->probabilityOfLenght(d)
-            * observation_evaluators[k]->evaluateSequence(i-d+1, i+1);
+  Matrix alpha;
+  Probability full = forward(xs, alpha, observation_evaluators);
+
+  posteriors.probabilities.reset(posteriors.states.size(), length);
+  posteriors.max_posteriors.resize(length);
+
+  // Backward pass: a column reads the columns up to the longest duration
+  // ahead, so only that many are kept, in a ring
+  auto supports = durationSupports();
+  auto geometric = geometricStates();
+  auto candidates = candidateSites(xs);
+
+  unsigned int max_duration = 1;
+  for (const auto& support : supports)
+    max_duration = std::max(max_duration, support.last());
+
+  unsigned int columns = std::min(max_duration + 1, length);
+  Matrix beta(_state_alphabet_size, columns);
+  Sequence path(length);
+
+  for (unsigned int k = 0; k < _state_alphabet_size; k++)
+    beta(k, (length - 1) % columns) = 1.0;
+
+  std::vector<Probability> exits(_state_alphabet_size);
+  for (unsigned int i = length; i-- > 0; ) {
+    if (i + 1 < length)
+      backwardColumn(xs, i, beta, columns, supports, geometric,
+                     candidates, exits, observation_evaluators);
+
+    Probability max = (alpha(0, i) * beta(0, i % columns)) / full;
+    path[i] = 0;
+    for (unsigned int k = 1; k < _state_alphabet_size; k++) {
+      Probability posterior = (alpha(k, i) * beta(k, i % columns)) / full;
+      if (posterior > max) {
+        max = posterior;
+        path[i] = k;
+      }
+    }
+    posteriors.max_posteriors[i] = max;
+
+    for (unsigned int r = 0; r < posteriors.states.size(); r++) {
+      auto k = posteriors.states[r];
+      posteriors.probabilities(r, i)
+        = (alpha(k, i) * beta(k, i % columns)) / full;
+    }
+  }
+
+  auto probability = pathProbability(path, observation_evaluators);
+  return Estimation<Labeling<Sequence>>(
+      Labeling<Sequence>(xs, std::move(path)), probability);
+}
+
+/*----------------------------------------------------------------------------*/
+
+std::vector<Estimation<Labeling<Sequence>>>
+GeneralizedHiddenMarkovModel::stochasticTraceback(
+      const Sequence& xs, const Matrix& alpha,
+      std::vector<EvaluatorPtr<Standard>>& observation_evaluators,
+      unsigned int number_of_samples,
+      RandomNumberGeneratorPtr rng,
+      unsigned int number_of_threads) const {
+  // The last segment ending at each position is drawn given its state, with
+  // the terms of the sum that computed alpha(k, end-1) as weights. A segment
+  // [0, end) starting the sequence is marked with the predecessor N
+  auto supports = durationSupports();
+  auto candidates = candidateSites(xs);
+  auto traceback = [this, &xs, &alpha, &observation_evaluators,
+                    &supports, &candidates] (
+      RandomNumberGenerator& generator) {
+    Sequence ys(xs.size());
+    std::vector<Probability> weights(_state_alphabet_size);
+    std::vector<unsigned int> durations, predecessors;
+
+    for (unsigned int k = 0; k < _state_alphabet_size; k++)
+      weights[k] = alpha(k, xs.size() - 1);
+    unsigned int state = drawIndex(weights, generator);
+
+    Probability probability = 1;
+    unsigned int end = xs.size();
+    while (end > 0) {
+      weights.clear();
+      durations.clear();
+      predecessors.clear();
+
+      auto duration = _states[state]->duration();
+      for (auto d : supports[state].upTo(end)) {
+        if (!candidates.admits(state, end - d)) continue;
+
+        Probability segment
+          = duration->probabilityOfLenght(d)
+          * observation_evaluators[state]->evaluateSequence(end - d, end);
+        if (d == end) {
+          weights.push_back(
+            _initial_probabilities->probabilityOf(state) * segment);
+          durations.push_back(d);
+          predecessors.push_back(_state_alphabet_size);
         } else {
-          Probability sum = 0;
-          for (auto p : _states[k]->predecessors()) {
-            sum += alpha[p][i-d] * _states[p]->transition()->probabilityOf(k);
+          for (auto p : _states[state]->predecessors()) {
+            weights.push_back(alpha(p, end - d - 1)
+              * _states[p]->transition()->probabilityOf(state) * segment);
+            durations.push_back(d);
+            predecessors.push_back(p);
           }
-          alpha[k][i] += sum * _states[k]->duration()->probabilityOfLenght(d)
-            * observation_evaluators[k]->evaluateSequence(i-d+1, i+1);
         }
       }
+      if (weights.empty()) break;
+
+      auto c = drawIndex(weights, generator);
+      auto begin = end - durations[c];
+      for (unsigned int i = begin; i < end; i++) ys[i] = state;
+
+      if (predecessors[c] == _state_alphabet_size) {
+        probability *= weights[c];
+        break;
+      }
+      probability *= weights[c] / alpha(predecessors[c], begin - 1);
+
+      state = predecessors[c];
+      end = begin;
     }
+
+    return Estimation<Labeling<Sequence>>(
+        Labeling<Sequence>(xs, std::move(ys)), probability);
+  };
+
+  return drawTracebacks(number_of_samples, rng, number_of_threads, traceback);
+}
+
+/*----------------------------------------------------------------------------*/
+
+Probability GeneralizedHiddenMarkovModel::forward(
+    const Sequence& seq, Matrix& alpha,
+    std::vector<EvaluatorPtr<Standard>>& observation_evaluators) const {
+  alpha.reset(_state_alphabet_size, seq.size());
+  auto supports = durationSupports();
+  auto geometric = geometricStates();
+  auto candidates = candidateSites(seq);
+
+  // Summed entry into each state from the segments ending at each position
+  Matrix entries(_state_alphabet_size, seq.size());
+
+  std::unique_lock<std::mutex> lock;
+  auto blocks = columnBlocks(supports, lock);
+
+  for (unsigned int i = 0; i < seq.size(); i++) {
+    computeColumn(blocks, [&] (unsigned int k) {
+      auto initial = _initial_probabilities->probabilityOf(k);
+      if (geometric[k]) {
+        alpha(k, i) = (i == 0 ? initial : entries(k, i-1))
+          * observation_evaluators[k]->evaluateSequence(i, i+1);
+        return;
+      }
+
+      auto duration = _states[k]->duration();
+      for (auto d : supports[k].upTo(i + 1)) {
+        if (!candidates.admits(k, i-d+1)) continue;
+
+        alpha(k, i) += (d > i ? initial : entries(k, i-d))
+          * duration->probabilityOfLenght(d)
+          * observation_evaluators[k]->evaluateSequence(i-d+1, i+1);
+      }
+    });
+
+    forwardEntries(alpha, i, entries);
   }
 
   Probability px = 0;
   for (unsigned int k = 0; k < _state_alphabet_size; k++)
-    px += alpha[k][seq.size()-1];
+    px += alpha(k, seq.size()-1);
 
   return px;
 }
@@ -458,38 +1253,29 @@ Probability GeneralizedHiddenMarkovModel::forward(
 Probability GeneralizedHiddenMarkovModel::backward(
     const Sequence& seq, Matrix& beta,
     std::vector<EvaluatorPtr<Standard>>& observation_evaluators) const {
-  beta = Matrix(_state_alphabet_size, std::vector<Probability>(seq.size()));
+  beta.reset(_state_alphabet_size, seq.size());
+  auto supports = durationSupports();
+  auto geometric = geometricStates();
+  auto candidates = candidateSites(seq);
 
   for (unsigned int k = 0; k < _state_alphabet_size; k++)
-    beta[k][seq.size()-1] = 1.0;
+    beta(k, seq.size()-1) = 1.0;
 
-  for (int i = seq.size()-2; i >= 0; i--) {
-    for (unsigned int k = 0; k < _state_alphabet_size; k++) {
-      for (auto p : _states[k]->successors()) {
-        auto range = _states[p]->duration()->range();
-        Probability sum = 0;
-        for (unsigned int d = range->begin();
-            !range->end() && d < (seq.size() - i);
-            d = range->next()) {
-          sum += _states[p]->duration()->probabilityOfLenght(d)
-            * observation_evaluators[p]->evaluateSequence(i+1, i+d+1)
-            * beta[p][i+d];
-        }
-        beta[k][i] += sum * _states[k]->transition()->probabilityOf(p);
-      }
-    }
-  }
+  std::vector<Probability> exits(_state_alphabet_size);
+  for (int i = seq.size()-2; i >= 0; i--)
+    backwardColumn(seq, i, beta, seq.size(), supports, geometric,
+                   candidates, exits, observation_evaluators);
 
   Probability px = 0;
   for (unsigned int k = 0; k < _state_alphabet_size; k++) {
+    if (!candidates.admits(k, 0)) continue;
+
     Probability sum = 0;
-    auto range = _states[k]->duration()->range();
-    for (unsigned int d = range->begin();
-        !range->end() && d <= (seq.size());
-        d = range->next()) {
-      sum += _states[k]->duration()->probabilityOfLenght(d)
+    auto duration = _states[k]->duration();
+    for (auto d : supports[k].upTo(seq.size())) {
+      sum += duration->probabilityOfLenght(d)
         * observation_evaluators[k]->evaluateSequence(0, d)
-        * beta[k][d-1];
+        * beta(k, d-1);
     }
     px += sum * _initial_probabilities->probabilityOf(k);
   }
@@ -499,6 +1285,207 @@ Probability GeneralizedHiddenMarkovModel::backward(
 
 /*----------------------------------------------------------------------------*/
 
+void GeneralizedHiddenMarkovModel::backwardColumn(
+    const Sequence& seq, unsigned int i, Matrix& beta, unsigned int columns,
+    const std::vector<DurationSupport>& supports,
+    const std::vector<char>& geometric,
+    const CandidateSites& candidates,
+    std::vector<Probability>& exits,
+    std::vector<EvaluatorPtr<Standard>>& observation_evaluators) const {
+  // Probability of the rest of the sequence given that a segment of state
+  // p starts at i+1, which does not depend on the state leaving at i
+  for (unsigned int p = 0; p < _state_alphabet_size; p++) {
+    if (!candidates.admits(p, i+1)) {
+      exits[p] = 0;
+      continue;
+    }
+
+    if (geometric[p]) {
+      exits[p] = observation_evaluators[p]->evaluateSequence(i+1, i+2)
+        * beta(p, (i+1) % columns);
+      continue;
+    }
+
+    auto duration = _states[p]->duration();
+    exits[p] = 0;
+    for (auto d : supports[p].upTo(seq.size() - i - 1)) {
+      exits[p] += duration->probabilityOfLenght(d)
+        * observation_evaluators[p]->evaluateSequence(i+1, i+d+1)
+        * beta(p, (i+d) % columns);
+    }
+  }
+
+  for (unsigned int k = 0; k < _state_alphabet_size; k++) {
+    beta(k, i % columns) = 0;
+    for (auto p : _states[k]->successors()) {
+      beta(k, i % columns)
+        += exits[p] * _states[k]->transition()->probabilityOf(p);
+    }
+  }
+}
+
+/*----------------------------------------------------------------------------*/
+
+void GeneralizedHiddenMarkovModel::viterbiEntries(
+    const Matrix& gamma, unsigned int i,
+    Matrix& entries, IndexMatrix& entry_states) const {
+  for (unsigned int k = 0; k < _state_alphabet_size; k++) {
+    for (auto p : _states[k]->predecessors()) {
+      Probability g = gamma(p, i) * _states[p]->transition()->probabilityOf(k);
+      if (entries(k, i) < g) {
+        entries(k, i) = g;
+        entry_states(k, i) = p;
+      }
+    }
+  }
+}
+
+/*----------------------------------------------------------------------------*/
+
+void GeneralizedHiddenMarkovModel::forwardEntries(
+    const Matrix& alpha, unsigned int i, Matrix& entries) const {
+  for (unsigned int k = 0; k < _state_alphabet_size; k++)
+    for (auto p : _states[k]->predecessors())
+      entries(k, i) += alpha(p, i) * _states[p]->transition()->probabilityOf(k);
+}
+
+/*----------------------------------------------------------------------------*/
+
+void GeneralizedHiddenMarkovModel::resetSegmentCounts(
+    SegmentCounts& counts) const {
+  counts.initials.assign(_state_alphabet_size, 0.0);
+  counts.transitions.reset(_state_alphabet_size, _state_alphabet_size);
+  counts.emissions.reset(_state_alphabet_size, _observation_alphabet_size);
+  counts.durations.assign(_state_alphabet_size, std::vector<double>());
+  counts.likelihood = 1;
+}
+
+/*----------------------------------------------------------------------------*/
+
+void GeneralizedHiddenMarkovModel::accumulateSegmentCounts(
+    const Sequence& xs, SegmentCounts& counts) const {
+  if (xs.empty()) return;
+
+  Matrix gamma;
+  std::vector<Segment> segments;
+  auto observation_evaluators = initializeObservationEvaluators(xs, false);
+  auto estimation = viterbi(xs, gamma, observation_evaluators, &segments);
+  if (!(Probability(0) < estimation.probability())) return;
+
+  counts.initials[segments[0].symbol()] += 1;
+  for (unsigned int s = 0; s < segments.size(); s++) {
+    auto state = segments[s].symbol();
+    unsigned int length = segments[s].end() - segments[s].begin();
+
+    for (int i = segments[s].begin(); i < segments[s].end(); i++)
+      counts.emissions(state, xs[i]) += 1;
+
+    // Geometric durations are made of self-transitions between segments
+    // of length 1, counted as any other transition
+    if (!std::dynamic_pointer_cast<GeometricDuration>(
+          _states[state]->duration())) {
+      auto& durations = counts.durations[state];
+      if (durations.size() <= length) durations.resize(length + 1, 0.0);
+      durations[length] += 1;
+    }
+
+    if (s + 1 < segments.size())
+      counts.transitions(state, segments[s+1].symbol()) += 1;
+  }
+
+  counts.likelihood = counts.likelihood * estimation.probability();
+}
+
+/*----------------------------------------------------------------------------*/
+
+void GeneralizedHiddenMarkovModel::mergeSegmentCounts(
+    SegmentCounts& counts, const SegmentCounts& other) {
+  for (unsigned int k = 0; k < counts.initials.size(); k++)
+    counts.initials[k] += other.initials[k];
+
+  for (unsigned int k = 0; k < counts.transitions.rows(); k++)
+    for (unsigned int l = 0; l < counts.transitions.columns(); l++)
+      counts.transitions(k, l) += other.transitions(k, l);
+
+  for (unsigned int k = 0; k < counts.emissions.rows(); k++)
+    for (unsigned int s = 0; s < counts.emissions.columns(); s++)
+      counts.emissions(k, s) += other.emissions(k, s);
+
+  for (unsigned int k = 0; k < counts.durations.size(); k++) {
+    auto& durations = counts.durations[k];
+    const auto& other_durations = other.durations[k];
+    if (durations.size() < other_durations.size())
+      durations.resize(other_durations.size(), 0.0);
+    for (unsigned int d = 0; d < other_durations.size(); d++)
+      durations[d] += other_durations[d];
+  }
+
+  counts.likelihood = counts.likelihood * other.likelihood;
+}
+
+/*----------------------------------------------------------------------------*/
+
+GeneralizedHiddenMarkovModelPtr
+GeneralizedHiddenMarkovModel::maximizeSegmentCounts(
+    const SegmentCounts& counts) const {
+  // Distributions without any count keep their current parameters
+  auto estimate = [](std::vector<double> values) -> DiscreteIIDModelPtr {
+    if (std::accumulate(values.begin(), values.end(), 0.0) == 0.0)
+      return nullptr;
+    return DiscreteIIDModel::make(DiscreteIIDModel::normalize(values));
+  };
+
+  std::vector<StatePtr> states(_state_alphabet_size);
+  for (unsigned int k = 0; k < _state_alphabet_size; k++) {
+    auto transitions = counts.transitions.row(k);
+    auto emissions = counts.emissions.row(k);
+
+    ProbabilisticModelPtr emission = _states[k]->emission();
+    DiscreteIIDModelPtr transition = _states[k]->transition();
+    DurationPtr duration = _states[k]->duration();
+
+    if (auto estimated = estimate({ transitions.begin(), transitions.end() }))
+      transition = estimated;
+
+    if (std::dynamic_pointer_cast<DiscreteIIDModel>(emission)) {
+      if (auto estimated = estimate({ emissions.begin(), emissions.end() }))
+        emission = estimated;
+    }
+
+    if (std::dynamic_pointer_cast<GeometricDuration>(duration)) {
+      duration = GeometricDuration::make(k, transition);
+    } else if (std::dynamic_pointer_cast<ExplicitDuration>(duration)) {
+      // Lengths are never longer than the range of the duration, which
+      // may be longer than its support (lengths with nonzero probability)
+      unsigned int max_duration = 0;
+      auto range = duration->range();
+      for (auto d = range->begin(); !range->end(); d = range->next())
+        max_duration = d;
+
+      auto histogram = counts.durations[k];
+      histogram.resize(max_duration + 1, 0.0);
+      if (auto estimated = estimate(histogram))
+        duration = ExplicitDuration::make(estimated, max_duration);
+    }
+
+    states[k] = State::make(k, emission, transition, duration);
+    for (auto predecessor : _states[k]->predecessors())
+      states[k]->addPredecessor(predecessor);
+    for (auto successor : _states[k]->successors())
+      states[k]->addSuccessor(successor);
+  }
+
+  DiscreteIIDModelPtr initial_probabilities = _initial_probabilities;
+  if (auto estimated = estimate(counts.initials))
+    initial_probabilities = estimated;
+
+  return GeneralizedHiddenMarkovModel::make(
+    states, initial_probabilities,
+    _state_alphabet_size, _observation_alphabet_size, _max_backtracking);
+}
+
+/*----------------------------------------------------------------------------*/
+
 std::vector<EvaluatorPtr<Standard>>
 GeneralizedHiddenMarkovModel::initializeObservationEvaluators(
     const Sequence& xs, bool cached) const {
@@ -36,7 +36,9 @@ namespace model {
 
 GeometricDuration::GeometricDuration(unsigned int id,
                                      ProbabilisticModelPtr transition)
-    : _id(id), _transition(std::move(transition)) {
+    : _id(id), _transition(std::move(transition)),
+      _self_transition(static_cast<double>(
+        _transition->standardEvaluator(Sequence{_id})->evaluateSymbol(0))) {
 }
 
 /*----------------------------------------------------------------------------*/
@@ -49,6 +51,12 @@ RangePtr GeometricDuration::range() const {
 
 /*----------------------------------------------------------------------------*/
 
+DurationSupport GeometricDuration::support() const {
+  return DurationSupport(1, 1);
+}
+
+/*----------------------------------------------------------------------------*/
+
 unsigned int GeometricDuration::maximumSize() const {
   return 1;
 }
@@ -58,9 +66,14 @@ unsigned int GeometricDuration::maximumSize() const {
 Probability
 GeometricDuration::probabilityOfLenght(unsigned int length) const {
   if (length == 1) return 1.0;
-  return std::pow(
-      _transition->standardEvaluator(Sequence{_id})->evaluateSymbol(0),
-      length-1);
+  return std::pow(_self_transition, length-1);
+}
+
+/*----------------------------------------------------------------------------*/
+
+Probability GeometricDuration::survival(unsigned int length) const {
+  if (length <= 1) return 1.0;
+  return std::pow(_self_transition, length-1);
 }
 
 /*----------------------------------------------------------------------------*/
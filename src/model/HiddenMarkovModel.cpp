@@ -23,13 +23,18 @@
 // Standard headers
 #include <cmath>
 #include <limits>
+#include <numeric>
 #include <vector>
 #include <utility>
 #include <algorithm>
+#include <unordered_map>
 
 // Internal headers
 #include "model/Util.hpp"
+#include "model/ThreadPool.hpp"
+#include "model/ViterbiKernel.hpp"
 
+#include "exception/OutOfRange.hpp"
 #include "exception/NotYetImplemented.hpp"
 
 namespace tops {
@@ -45,7 +50,14 @@ HiddenMarkovModel::HiddenMarkovModel(
     unsigned int state_alphabet_size,
     unsigned int observation_alphabet_size)
     : Base(std::move(states), initial_probabilities,
-           state_alphabet_size, observation_alphabet_size) {
+           state_alphabet_size, observation_alphabet_size),
+      _parameters(compileParameters()) {
+}
+
+/*----------------------------------------------------------------------------*/
+
+HiddenMarkovModel::HiddenMarkovModel(const HiddenMarkovModel& other)
+    : Base(other), _parameters(other.parameters()) {
 }
 
 /*----------------------------------------------------------------------------*/
@@ -57,79 +69,76 @@ HiddenMarkovModel::train(TrainerPtr<Standard, Self> trainer,
                          baum_welch_algorithm,
                          HiddenMarkovModelPtr initial_model,
                          unsigned int max_iterations,
-                         double diff_threshold) {
-  auto& observation_training_set = trainer->training_set();
+                         double diff_threshold,
+                         unsigned int number_of_threads) {
+  return expectationMaximization(
+    trainer, initial_model, max_iterations, diff_threshold,
+    number_of_threads, &Self::accumulateExpectedCounts);
+}
 
-  auto state_alphabet_size = initial_model->stateAlphabetSize();
-  auto observation_alphabet_size = initial_model->observationAlphabetSize();
+/*----------------------------------------------------------------------------*/
 
-  auto model = HiddenMarkovModel::make(*initial_model);
+HiddenMarkovModelPtr
+HiddenMarkovModel::train(TrainerPtr<Standard, Self> trainer,
+                         viterbi_training_algorithm,
+                         HiddenMarkovModelPtr initial_model,
+                         unsigned int max_iterations,
+                         double diff_threshold,
+                         unsigned int number_of_threads) {
+  return expectationMaximization(
+    trainer, initial_model, max_iterations, diff_threshold,
+    number_of_threads, &Self::accumulateViterbiCounts);
+}
 
-  for (const auto& training_sequence : observation_training_set) {
-    double last = 0;
-    for (unsigned int iteration = 0; iteration < max_iterations; iteration++) {
-      Matrix alpha, beta;
-      Probability P = model->forward(training_sequence, alpha);
-      model->backward(training_sequence, beta);
-
-      std::vector<Probability> pi(state_alphabet_size);
-      {
-        Probability sum = 0;
-        for (unsigned int i = 0; i < state_alphabet_size; i++)
-          sum += alpha[i][0] * beta[i][0];
-
-        for (unsigned int i = 0; i < state_alphabet_size; i++)
-          pi[i] = (alpha[i][0] * beta[i][0]) / sum;
-      }
+/*----------------------------------------------------------------------------*/
 
-      Matrix A(state_alphabet_size,
-               std::vector<Probability>(observation_alphabet_size));
-      for (size_t i = 0; i < state_alphabet_size; i++)
-        for (size_t j = 0; j < state_alphabet_size; j++)
-          for (size_t t = 0; t < training_sequence.size()-1; t++)
-            A[i][j] += alpha[i][t]
-              * model->state(i)->transition()->probabilityOf(j)
-              * model->state(j)->emission()->probabilityOf(
-                  training_sequence[t+1])
-              * beta[j][t+1];
-
-      Matrix E(state_alphabet_size,
-               std::vector<Probability>(state_alphabet_size));
-      for (size_t i = 0; i < state_alphabet_size; i++)
-        for (size_t sigma = 0; sigma < observation_alphabet_size; sigma++)
-          for (size_t t = 0; t < training_sequence.size(); t++)
-            if (sigma == training_sequence[t])
-              E[i][sigma] += alpha[i][t] * beta[i][t];
-
-      std::vector<Probability> sumA(state_alphabet_size);
-      std::vector<Probability> sumE(state_alphabet_size);
-      for (unsigned int k = 0; k < state_alphabet_size; k++) {
-        sumA[k] = std::accumulate(A[k].begin(), A[k].end(), Probability(0.0));
-        sumE[k] = std::accumulate(E[k].begin(), E[k].end(), Probability(0.0));
-      }
+HiddenMarkovModelPtr
+HiddenMarkovModel::train(TrainerPtr<Standard, Self> trainer,
+                         online_baum_welch_algorithm,
+                         HiddenMarkovModelPtr initial_model,
+                         std::function<bool(Sequence&)> next_sequence,
+                         double decay,
+                         unsigned int snapshot_interval,
+                         std::function<void(SelfPtr)> snapshot) {
+  // Stepwise EM converges only if the steps sum to infinity while their
+  // squares do not
+  if (!(decay > 0.5 && decay <= 1.0)) throw_exception(OutOfRange);
 
-      std::vector<StatePtr> states(state_alphabet_size);
-      for (size_t k = 0; k < state_alphabet_size; k++) {
-        for (size_t l = 0; l < state_alphabet_size; l++)
-          A[k][l] /= sumA[k];
-        for (size_t b = 0; b < observation_alphabet_size; b++)
-          E[k][b] /= sumE[k];
+  auto& observation_training_set = trainer->training_set();
 
-        states[k] = State::make(
-          k, DiscreteIIDModel::make(E[k]), DiscreteIIDModel::make(A[k]));
-      }
+  auto model = HiddenMarkovModel::make(*initial_model);
+
+  // Running statistics and counts of the current sequence, whose sizes
+  // depend only on the model
+  ExpectedCounts statistics, counts;
+  model->resetExpectedCounts(statistics);
 
-      model = HiddenMarkovModel::make(
-        states, DiscreteIIDModel::make(pi),
-        state_alphabet_size, observation_alphabet_size);
+  unsigned int k = 0;
+  auto update = [&](const Sequence& training_sequence) {
+    model->resetExpectedCounts(counts);
+    model->accumulateExpectedCounts(training_sequence, counts);
 
-      auto diff = std::fabs(last - P.data());
-      last = P.data();
+    interpolateExpectedCounts(
+      statistics, counts, std::pow(k + 2.0, -decay));
+    model->maximizeExpectedCounts(statistics);
+    k++;
 
-      if (diff < diff_threshold) break;
+    if (snapshot && snapshot_interval > 0 && k % snapshot_interval == 0) {
+      model->updateStates();
+      snapshot(HiddenMarkovModel::make(*model));
     }
+  };
+
+  for (const auto& training_sequence : observation_training_set)
+    update(training_sequence);
+
+  if (next_sequence) {
+    Sequence training_sequence;
+    while (next_sequence(training_sequence))
+      update(training_sequence);
   }
 
+  model->updateStates();
   return model;
 }
 
@@ -206,9 +215,9 @@ HiddenMarkovModel::evaluateSequence(SEPtr<Standard> evaluator,
   Probability sum_end = 0;
 
   for (unsigned int k = 0; k < _state_alphabet_size; k++) {
-    sum_end += alpha[k][end-1];
+    sum_end += alpha(k, end-1);
     if (begin != 0)
-      sum_begin += alpha[k][begin-1];
+      sum_begin += alpha(k, begin-1);
     else
       sum_begin = 1;
   }
@@ -228,7 +237,7 @@ void HiddenMarkovModel::initializeCache(CEPtr<Standard> evaluator,
   for (unsigned int i = 0; i < evaluator->sequence().size(); i++) {
     cache.prefix_sum_array[i] = 0;
     for (unsigned int k = 0; k < _state_alphabet_size; k++)
-      cache.prefix_sum_array[i+1] += cache.alpha[k][i];
+      cache.prefix_sum_array[i+1] += cache.alpha(k, i);
   }
 }
 
@@ -287,20 +296,16 @@ void HiddenMarkovModel::serialize(SSPtr serializer) {
 Probability HiddenMarkovModel::evaluateSymbol(SEPtr<Labeling> evaluator,
                                               unsigned int pos,
                                               unsigned int /* phase */) const {
-  Probability transition;
+  auto compiled = this->parameters();
+  const auto& parameters = *compiled;
   const Sequence& observation = evaluator->sequence().observation();
   const Sequence& label = evaluator->sequence().label();
 
-  if (pos == 0)
-    transition = _initial_probabilities
-      ->standardEvaluator(label)->evaluateSymbol(0);
-  else
-    transition = _states[label[pos-1]]->transition()
-      ->standardEvaluator(label)->evaluateSymbol(pos);
+  Probability transition = (pos == 0)
+    ? parameters.initials[label[0]]
+    : parameters.transitions(label[pos-1], label[pos]);
 
-  return transition
-    * _states[label[pos]]->emission()
-      ->standardEvaluator(observation)->evaluateSymbol(pos);
+  return transition * parameters.emissions(label[pos], observation[pos]);
 }
 
 /*----------------------------------------------------------------------------*/
@@ -382,10 +387,18 @@ Estimation<Labeling<Sequence>>
 HiddenMarkovModel::labeling(SLPtr labeler,
                             const Labeler::method& method) const {
   Matrix probabilities;
+  bool checkpointed
+    = labeler->memoryMode() == Labeler::memory::checkpointed;
+
   switch (method) {
     case Labeler::method::bestPath:
+      if (checkpointed) return checkpointedViterbi(labeler->sequence());
       return viterbi(labeler->sequence(), probabilities);
+    case Labeler::method::vectorizedBestPath:
+      return vectorizedViterbi(labeler->sequence());
     case Labeler::method::posteriorDecoding:
+      if (checkpointed)
+        return checkpointedPosteriorDecoding(labeler->sequence());
       return posteriorDecoding(labeler->sequence(), probabilities);
   }
   return Estimation<Labeling<Sequence>>();
@@ -393,8 +406,44 @@ HiddenMarkovModel::labeling(SLPtr labeler,
 
 /*----------------------------------------------------------------------------*/
 
-void HiddenMarkovModel::initializeCache(CLPtr /* labeler */) {
+Estimation<Labeling<Sequence>>
+HiddenMarkovModel::labeling(SLPtr labeler, Beam& beam) const {
+  return beamViterbi(labeler->sequence(), beam);
+}
+
+/*----------------------------------------------------------------------------*/
+
+Estimation<Labeling<Sequence>>
+HiddenMarkovModel::labeling(SLPtr labeler, Posteriors& posteriors) const {
+  return fusedPosteriorDecoding(labeler->sequence(), posteriors);
+}
+
+/*----------------------------------------------------------------------------*/
+
+Estimation<Labeling<Sequence>>
+HiddenMarkovModel::labeling(SLPtr labeler, NBest& nbest) const {
+  if (nbest.lazy) return lazyListViterbi(labeler->sequence(), nbest);
+  return listViterbi(labeler->sequence(), nbest);
+}
+
+/*----------------------------------------------------------------------------*/
+
+std::vector<Estimation<Labeling<Sequence>>>
+HiddenMarkovModel::sampling(SLPtr labeler,
+                            unsigned int number_of_samples,
+                            RandomNumberGeneratorPtr rng,
+                            unsigned int number_of_threads) const {
+  Matrix alpha;
+  forward(labeler->sequence(), alpha);
+  return stochasticTraceback(labeler->sequence(), alpha,
+                             number_of_samples, rng, number_of_threads);
+}
+
+/*----------------------------------------------------------------------------*/
+
+void HiddenMarkovModel::initializeCache(CLPtr labeler) {
   // Postpone initialization to methods
+  labeler->cache().filled_alpha = false;
 }
 
 /*----------------------------------------------------------------------------*/
@@ -402,16 +451,62 @@ void HiddenMarkovModel::initializeCache(CLPtr /* labeler */) {
 Estimation<Labeling<Sequence>>
 HiddenMarkovModel::labeling(CLPtr labeler,
                             const Labeler::method& method) const {
+  bool checkpointed
+    = labeler->memoryMode() == Labeler::memory::checkpointed;
+
   switch (method) {
     case Labeler::method::bestPath:
+      if (checkpointed) return checkpointedViterbi(labeler->sequence());
       return viterbi(labeler->sequence(), labeler->cache().gamma);
+    case Labeler::method::vectorizedBestPath:
+      return vectorizedViterbi(labeler->sequence());
     case Labeler::method::posteriorDecoding:
+      if (checkpointed)
+        return checkpointedPosteriorDecoding(labeler->sequence());
       return posteriorDecoding(labeler->sequence(),
              labeler->cache().posterior_decoding);
   }
   return Estimation<Labeling<Sequence>>();
 }
 
+/*----------------------------------------------------------------------------*/
+
+Estimation<Labeling<Sequence>>
+HiddenMarkovModel::labeling(CLPtr labeler, Beam& beam) const {
+  return beamViterbi(labeler->sequence(), beam);
+}
+
+/*----------------------------------------------------------------------------*/
+
+Estimation<Labeling<Sequence>>
+HiddenMarkovModel::labeling(CLPtr labeler, Posteriors& posteriors) const {
+  return fusedPosteriorDecoding(labeler->sequence(), posteriors);
+}
+
+/*----------------------------------------------------------------------------*/
+
+Estimation<Labeling<Sequence>>
+HiddenMarkovModel::labeling(CLPtr labeler, NBest& nbest) const {
+  if (nbest.lazy) return lazyListViterbi(labeler->sequence(), nbest);
+  return listViterbi(labeler->sequence(), nbest);
+}
+
+/*----------------------------------------------------------------------------*/
+
+std::vector<Estimation<Labeling<Sequence>>>
+HiddenMarkovModel::sampling(CLPtr labeler,
+                            unsigned int number_of_samples,
+                            RandomNumberGeneratorPtr rng,
+                            unsigned int number_of_threads) const {
+  auto& cache = labeler->cache();
+  if (!cache.filled_alpha) {
+    forward(labeler->sequence(), cache.alpha);
+    cache.filled_alpha = true;
+  }
+  return stochasticTraceback(labeler->sequence(), cache.alpha,
+                             number_of_samples, rng, number_of_threads);
+}
+
 /*==============================  CALCULATOR  ================================*/
 
 Probability HiddenMarkovModel::calculate(
@@ -452,8 +547,7 @@ Probability HiddenMarkovModel::calculate(
 
 void HiddenMarkovModel::posteriorProbabilities(const Sequence& sequence,
                                                Matrix& probabilities) const {
-  probabilities = std::vector<std::vector<Probability>>(
-      _state_alphabet_size, std::vector<Probability>(sequence.size()));
+  probabilities.reset(_state_alphabet_size, sequence.size());
 
   Matrix alpha;  // forward
   Matrix beta;   // backward
@@ -463,54 +557,463 @@ void HiddenMarkovModel::posteriorProbabilities(const Sequence& sequence,
 
   for (unsigned int k = 0; k < _state_alphabet_size; k++)
     for (unsigned int i = 0; i < sequence.size(); i++)
-      probabilities[k][i] = (alpha[k][i] * beta[k][i]) / full;
+      probabilities(k, i) = (alpha(k, i) * beta(k, i)) / full;
 }
 
 /*----------------------------------------------------------------------------*/
 /*                             CONCRETE METHODS                               */
 /*----------------------------------------------------------------------------*/
 
+auto HiddenMarkovModel::parameters() const -> ParametersPtr {
+  return std::atomic_load(&_parameters);
+}
+
+/*----------------------------------------------------------------------------*/
+
+void HiddenMarkovModel::updateParameters() {
+  std::atomic_store(&_parameters, compileParameters());
+}
+
+/*----------------------------------------------------------------------------*/
+
+auto HiddenMarkovModel::compileParameters() const -> ParametersPtr {
+  auto parameters = std::make_shared<Parameters>();
+
+  // Transitions are read row by row (all targets of a state) and emissions
+  // column by column (all states emitting the same symbol)
+  parameters->initials.resize(_state_alphabet_size);
+  parameters->transitions = Matrix(_state_alphabet_size, _state_alphabet_size,
+                                   Matrix::layout::stateMajor);
+  parameters->emissions = Matrix(_state_alphabet_size,
+                                 _observation_alphabet_size,
+                                 Matrix::layout::positionMajor);
+
+  for (unsigned int k = 0; k < _state_alphabet_size; k++) {
+    parameters->initials[k] = _initial_probabilities->probabilityOf(k);
+    for (unsigned int l = 0; l < _state_alphabet_size; l++)
+      parameters->transitions(k, l)
+        = _states[k]->transition()->probabilityOf(l);
+    for (unsigned int s = 0; s < _observation_alphabet_size; s++)
+      parameters->emissions(k, s) = _states[k]->emission()->probabilityOf(s);
+  }
+
+  compileLogParameters(*parameters);
+  compileSparseTransitions(*parameters);
+
+  return parameters;
+}
+
+/*----------------------------------------------------------------------------*/
+
+void HiddenMarkovModel::compileLogParameters(Parameters& parameters) const {
+  parameters.log_initials.resize(_state_alphabet_size);
+  parameters.log_transitions = BasicMatrix<double>(
+    _state_alphabet_size, _state_alphabet_size,
+    BasicMatrix<double>::layout::stateMajor);
+  parameters.log_emissions = BasicMatrix<double>(
+    _state_alphabet_size, _observation_alphabet_size,
+    BasicMatrix<double>::layout::positionMajor);
+
+  for (unsigned int k = 0; k < _state_alphabet_size; k++) {
+    parameters.log_initials[k]
+      = std::log(static_cast<double>(parameters.initials[k]));
+    for (unsigned int l = 0; l < _state_alphabet_size; l++)
+      parameters.log_transitions(k, l)
+        = std::log(static_cast<double>(parameters.transitions(k, l)));
+    for (unsigned int s = 0; s < _observation_alphabet_size; s++)
+      parameters.log_emissions(k, s)
+        = std::log(static_cast<double>(parameters.emissions(k, s)));
+  }
+}
+
+/*----------------------------------------------------------------------------*/
+
+void HiddenMarkovModel::compileSparseTransitions(
+    Parameters& parameters) const {
+  const auto& transitions = parameters.transitions;
+  auto& incoming = parameters.incoming;
+  auto& outgoing = parameters.outgoing;
+
+  incoming = SparseTransitions();
+  outgoing = SparseTransitions();
+
+  incoming.offsets.push_back(0);
+  outgoing.offsets.push_back(0);
+  for (unsigned int k = 0; k < _state_alphabet_size; k++) {
+    for (unsigned int l = 0; l < _state_alphabet_size; l++) {
+      if (Probability(0) < transitions(l, k)) {
+        incoming.states.push_back(l);
+        incoming.probabilities.push_back(transitions(l, k));
+      }
+      if (Probability(0) < transitions(k, l)) {
+        outgoing.states.push_back(l);
+        outgoing.probabilities.push_back(transitions(k, l));
+      }
+    }
+    incoming.offsets.push_back(incoming.states.size());
+    outgoing.offsets.push_back(outgoing.states.size());
+  }
+
+  // Indirect accesses only pay off when most of the transitions are zero
+  parameters.sparse = 4 * incoming.states.size()
+                        <= _state_alphabet_size * _state_alphabet_size;
+}
+
+/*----------------------------------------------------------------------------*/
+
+HiddenMarkovModelPtr
+HiddenMarkovModel::expectationMaximization(
+    TrainerPtr<Standard, Self> trainer,
+    HiddenMarkovModelPtr initial_model,
+    unsigned int max_iterations,
+    double diff_threshold,
+    unsigned int number_of_threads,
+    Accumulator accumulate) {
+  auto& observation_training_set = trainer->training_set();
+
+  auto model = HiddenMarkovModel::make(*initial_model);
+  if (observation_training_set.empty()) return model;
+
+  auto pool = ThreadPool::make(number_of_threads);
+
+  // One block of contiguous sequences per worker, with similar lengths.
+  // Blocks are always merged in the same order, so the result does not
+  // depend on the threads' scheduling
+  std::vector<std::size_t> lengths;
+  for (const auto& training_sequence : observation_training_set)
+    lengths.push_back(training_sequence.size());
+
+  auto limits = ThreadPool::partition(lengths, pool->size());
+  std::vector<ExpectedCounts> counts(limits.size() - 1);
+
+  double last = 0;
+  for (unsigned int iteration = 0; iteration < max_iterations; iteration++) {
+    // E-step
+    pool->parallelFor(counts.size(), [&](std::size_t block, unsigned int) {
+      model->resetExpectedCounts(counts[block]);
+      for (auto s = limits[block]; s < limits[block+1]; s++)
+        ((*model).*accumulate)(observation_training_set[s], counts[block]);
+    });
+
+    for (std::size_t block = 1; block < counts.size(); block++)
+      mergeExpectedCounts(counts[0], counts[block]);
+
+    // M-step
+    model->maximizeExpectedCounts(counts[0]);
+
+    auto diff = std::fabs(last - counts[0].likelihood.data());
+    last = counts[0].likelihood.data();
+
+    if (diff < diff_threshold) break;
+  }
+
+  model->updateStates();
+  return model;
+}
+
+/*----------------------------------------------------------------------------*/
+
+void HiddenMarkovModel::resetExpectedCounts(ExpectedCounts& counts) const {
+  auto compiled = this->parameters();
+  const auto& parameters = *compiled;
+
+  // Transitions are accumulated row by row
+  counts.transitions.relayout(BasicMatrix<double>::layout::stateMajor);
+  counts.linear_transitions.relayout(BasicMatrix<double>::layout::stateMajor);
+
+  counts.initials.assign(_state_alphabet_size, 0.0);
+  counts.transitions.reset(_state_alphabet_size, _state_alphabet_size);
+  counts.emissions.reset(_state_alphabet_size, _observation_alphabet_size);
+  counts.likelihood = 1;
+
+  counts.linear_transitions.reset(_state_alphabet_size, _state_alphabet_size);
+  for (unsigned int i = 0; i < _state_alphabet_size; i++)
+    for (unsigned int j = 0; j < _state_alphabet_size; j++)
+      counts.linear_transitions(i, j)
+        = static_cast<double>(parameters.transitions(i, j));
+}
+
+/*----------------------------------------------------------------------------*/
+
+void HiddenMarkovModel::accumulateExpectedCounts(
+    const Sequence& xs, ExpectedCounts& counts) const {
+  if (xs.empty()) return;
+
+  auto compiled = this->parameters();
+  const auto& parameters = *compiled;
+  auto& alpha = counts.alpha;
+  auto& beta = counts.beta;
+
+  Probability P = forward(xs, alpha);
+  backward(xs, beta);
+
+  if (!(Probability(0) < P)) return;
+
+  // Counts of each sequence are weighted by its own probability
+  for (unsigned int i = 0; i < _state_alphabet_size; i++)
+    counts.initials[i] += static_cast<double>((alpha(i, 0) * beta(i, 0)) / P);
+
+  // Emissions: only the observed symbol of each position is counted
+  for (unsigned int t = 0; t < xs.size(); t++)
+    for (unsigned int i = 0; i < _state_alphabet_size; i++)
+      counts.emissions(i, xs[t])
+        += static_cast<double>((alpha(i, t) * beta(i, t)) / P);
+
+  // Transitions: the terms of each position are rescaled by the largest
+  // forward and backward values, so that the O(N^2) inner loop runs over
+  // plain doubles, taking only O(N) conversions from log-space per position.
+  // The maxima are taken over the states on some path of the sequence: a
+  // dead end (with a large alpha but a null beta) would otherwise make the
+  // scaled values of all other states underflow
+  auto& scaled_alpha = counts.scaled_alpha;
+  auto& scaled_beta = counts.scaled_beta;
+  scaled_alpha.resize(_state_alphabet_size);
+  scaled_beta.resize(_state_alphabet_size);
+
+  for (unsigned int t = 0; t + 1 < xs.size(); t++) {
+    Probability max_alpha = 0, max_beta = 0;
+    for (unsigned int i = 0; i < _state_alphabet_size; i++) {
+      auto next = parameters.emissions(i, xs[t+1]) * beta(i, t+1);
+      if (Probability(0) < alpha(i, t) * beta(i, t) && max_alpha < alpha(i, t))
+        max_alpha = alpha(i, t);
+      if (Probability(0) < alpha(i, t+1) * beta(i, t+1) && max_beta < next)
+        max_beta = next;
+    }
+
+    if (!(Probability(0) < max_alpha) || !(Probability(0) < max_beta))
+      continue;
+
+    // Terms of the states left out are null, so they are not scaled
+    for (unsigned int i = 0; i < _state_alphabet_size; i++) {
+      scaled_alpha[i] = Probability(0) < alpha(i, t) * beta(i, t)
+        ? static_cast<double>(alpha(i, t) / max_alpha) : 0.0;
+      scaled_beta[i] = Probability(0) < alpha(i, t+1) * beta(i, t+1)
+        ? static_cast<double>(
+            (parameters.emissions(i, xs[t+1]) * beta(i, t+1)) / max_beta)
+        : 0.0;
+    }
+
+    auto scale = static_cast<double>((max_alpha * max_beta) / P);
+    if (!std::isfinite(scale)) {
+      accumulateTransitions(xs, t, P, counts);
+      continue;
+    }
+
+    for (unsigned int i = 0; i < _state_alphabet_size; i++) {
+      auto weight = scale * scaled_alpha[i];
+      if (weight == 0.0) continue;
+
+      const double* transitions = counts.linear_transitions.row(i).data();
+      double* row = counts.transitions.row(i).data();
+      for (unsigned int j = 0; j < _state_alphabet_size; j++)
+        row[j] += weight * transitions[j] * scaled_beta[j];
+    }
+  }
+
+  counts.likelihood = counts.likelihood * P;
+}
+
+/*----------------------------------------------------------------------------*/
+
+void HiddenMarkovModel::accumulateTransitions(
+    const Sequence& xs, unsigned int t, Probability P,
+    ExpectedCounts& counts) const {
+  auto compiled = this->parameters();
+  const auto& parameters = *compiled;
+  for (unsigned int i = 0; i < _state_alphabet_size; i++)
+    for (unsigned int j = 0; j < _state_alphabet_size; j++)
+      counts.transitions(i, j) += static_cast<double>(
+        (counts.alpha(i, t) * parameters.transitions(i, j)
+          * parameters.emissions(j, xs[t+1]) * counts.beta(j, t+1)) / P);
+}
+
+/*----------------------------------------------------------------------------*/
+
+void HiddenMarkovModel::accumulateViterbiCounts(
+    const Sequence& xs, ExpectedCounts& counts) const {
+  if (xs.empty()) return;
+
+  // Only the best path is counted, so neither the forward nor the
+  // backward table is needed
+  auto estimation = vectorizedViterbi(xs);
+  if (!(Probability(0) < estimation.probability())) return;
+
+  const auto& ys = estimation.estimated().label();
+
+  counts.initials[ys[0]] += 1;
+  for (unsigned int t = 0; t < xs.size(); t++) {
+    counts.emissions(ys[t], xs[t]) += 1;
+    if (t + 1 < xs.size()) counts.transitions(ys[t], ys[t+1]) += 1;
+  }
+
+  counts.likelihood = counts.likelihood * estimation.probability();
+}
+
+/*----------------------------------------------------------------------------*/
+
+void HiddenMarkovModel::mergeExpectedCounts(ExpectedCounts& counts,
+                                            const ExpectedCounts& other) {
+  for (unsigned int i = 0; i < counts.initials.size(); i++)
+    counts.initials[i] += other.initials[i];
+
+  for (unsigned int i = 0; i < counts.transitions.rows(); i++)
+    for (unsigned int j = 0; j < counts.transitions.columns(); j++)
+      counts.transitions(i, j) += other.transitions(i, j);
+
+  for (unsigned int i = 0; i < counts.emissions.rows(); i++)
+    for (unsigned int sigma = 0; sigma < counts.emissions.columns(); sigma++)
+      counts.emissions(i, sigma) += other.emissions(i, sigma);
+
+  counts.likelihood = counts.likelihood * other.likelihood;
+}
+
+/*----------------------------------------------------------------------------*/
+
+void HiddenMarkovModel::interpolateExpectedCounts(ExpectedCounts& counts,
+                                                  const ExpectedCounts& other,
+                                                  double step) {
+  for (unsigned int i = 0; i < counts.initials.size(); i++)
+    counts.initials[i] = (1 - step) * counts.initials[i]
+                       + step * other.initials[i];
+
+  for (unsigned int i = 0; i < counts.transitions.rows(); i++)
+    for (unsigned int j = 0; j < counts.transitions.columns(); j++)
+      counts.transitions(i, j) = (1 - step) * counts.transitions(i, j)
+                               + step * other.transitions(i, j);
+
+  for (unsigned int i = 0; i < counts.emissions.rows(); i++)
+    for (unsigned int sigma = 0; sigma < counts.emissions.columns(); sigma++)
+      counts.emissions(i, sigma) = (1 - step) * counts.emissions(i, sigma)
+                                 + step * other.emissions(i, sigma);
+
+  counts.likelihood = other.likelihood;
+}
+
+/*----------------------------------------------------------------------------*/
+
+void HiddenMarkovModel::maximizeExpectedCounts(const ExpectedCounts& counts) {
+  // The new parameters are written straight into a copy of the compiled
+  // tables; states are only rebuilt by updateStates(), once training is over
+  auto normalize = [](auto counted, auto probabilities) {
+    double sum = 0;
+    for (auto count : counted) sum += count;
+    if (sum == 0.0) return;  // Never visited: keep the current parameters
+
+    auto it = probabilities.begin();
+    for (auto count : counted) *it++ = Probability(count / sum);
+  };
+
+  auto updated = std::make_shared<Parameters>(*this->parameters());
+  auto& parameters = *updated;
+
+  normalize(counts.initials, Matrix::View(
+    parameters.initials.data(), parameters.initials.size(), 1));
+
+  for (unsigned int k = 0; k < _state_alphabet_size; k++) {
+    normalize(counts.transitions.row(k), parameters.transitions.row(k));
+    normalize(counts.emissions.row(k), parameters.emissions.row(k));
+  }
+
+  compileLogParameters(parameters);
+  compileSparseTransitions(parameters);
+
+  std::atomic_store(&_parameters, ParametersPtr(std::move(updated)));
+}
+
+/*----------------------------------------------------------------------------*/
+
+void HiddenMarkovModel::updateStates() {
+  auto compiled = this->parameters();
+  const auto& parameters = *compiled;
+
+  auto distribution = [](Matrix::ConstView probabilities) {
+    return DiscreteIIDModel::make(std::vector<Probability>(
+      probabilities.begin(), probabilities.end()));
+  };
+
+  for (unsigned int k = 0; k < _state_alphabet_size; k++) {
+    _states[k] = State::make(k, distribution(parameters.emissions.row(k)),
+                                distribution(parameters.transitions.row(k)));
+  }
+
+  _initial_probabilities = DiscreteIIDModel::make(parameters.initials);
+}
+
+/*----------------------------------------------------------------------------*/
+
 Estimation<Labeling<Sequence>>
 HiddenMarkovModel::viterbi(const Sequence& xs,
                            Matrix& gamma) const {
-  gamma = std::vector<std::vector<Probability>>(
-      _state_alphabet_size, std::vector<Probability>(xs.size()));
-  Matrix psi(_state_alphabet_size, std::vector<Probability>(xs.size()));
+  auto compiled = this->parameters();
+  const auto& parameters = *compiled;
+
+  gamma.reset(_state_alphabet_size, xs.size());
+  IndexMatrix psi(_state_alphabet_size, xs.size());
 
   for (unsigned int k = 0; k < _state_alphabet_size; k++)
-    gamma[k][0] = _initial_probabilities->probabilityOf(k)
-        * _states[k]->emission()->probabilityOf(xs[0]);
+    gamma(k, 0) = parameters.initials[k] * parameters.emissions(k, xs[0]);
 
-  for (unsigned int i = 0; i < xs.size() - 1; i++) {
-    for (unsigned int k = 0; k < _state_alphabet_size; k++) {
-      gamma[k][i+1] = gamma[0][i]
-          * _states[0]->transition()->probabilityOf(k);
-      psi[k][i+1] = 0;
-      for (unsigned int p = 1; p < _state_alphabet_size; p++) {
-        Probability v
-          = gamma[p][i] * _states[p]->transition()->probabilityOf(k);
-        if (gamma[k][i+1] < v) {
-          gamma[k][i+1] = v;
-          psi[k][i+1] = p;
-        }
-      }
-      gamma[k][i+1] *= _states[k]->emission()->probabilityOf(xs[i+1]);
-    }
-  }
+  for (unsigned int i = 0; i < xs.size() - 1; i++)
+    viterbiColumn(parameters, gamma.column(i), xs[i+1],
+                  gamma.column(i+1), psi.column(i+1));
 
   Sequence ys(xs.size());
   ys[xs.size() - 1] = 0;
-  Probability max = gamma[0][xs.size() - 1];
+  Probability max = gamma(0, xs.size() - 1);
   for (unsigned int k = 1; k < _state_alphabet_size; k++) {
-    if (max < gamma[k][xs.size() - 1]) {
-      max = gamma[k][xs.size() - 1];
+    if (max < gamma(k, xs.size() - 1)) {
+      max = gamma(k, xs.size() - 1);
       ys[xs.size() - 1] = k;
     }
   }
   for (int i = xs.size() - 1; i >= 1; i--) {
-    ys[i-1] = psi[ys[i]][i];
+    ys[i-1] = psi(ys[i], i);
+  }
+
+  return Estimation<Labeling<Sequence>>(
+      Labeling<Sequence>(xs, std::move(ys)), max);
+}
+
+/*----------------------------------------------------------------------------*/
+
+Estimation<Labeling<Sequence>>
+HiddenMarkovModel::vectorizedViterbi(const Sequence& xs) const {
+  auto compiled = this->parameters();
+  const auto& parameters = *compiled;
+  const auto& log_emissions = parameters.log_emissions;
+
+  auto extension = ViterbiKernel::available();
+
+  // Only the last column of scores is needed by the recursion
+  std::vector<double, AlignedAllocator<double>>
+    previous(_state_alphabet_size), current(_state_alphabet_size);
+  IndexMatrix psi(_state_alphabet_size, xs.size());
+
+  for (unsigned int k = 0; k < _state_alphabet_size; k++)
+    previous[k] = parameters.log_initials[k] + log_emissions(k, xs[0]);
+
+  for (unsigned int i = 1; i < xs.size(); i++) {
+    ViterbiKernel::step(extension, _state_alphabet_size,
+                        previous.data(),
+                        parameters.log_transitions.data(),
+                        log_emissions.column(xs[i]).data(),
+                        current.data(),
+                        psi.column(i).data());
+    std::swap(previous, current);
   }
 
+  Sequence ys(xs.size());
+  ys[xs.size() - 1] = 0;
+  for (unsigned int k = 1; k < _state_alphabet_size; k++)
+    if (previous[ys[xs.size() - 1]] < previous[k])
+      ys[xs.size() - 1] = k;
+  for (int i = xs.size() - 1; i >= 1; i--)
+    ys[i-1] = psi(ys[i], i);
+
+  // Score the path with the tables of probabilities, avoiding
+  // a conversion from plain log-probabilities
+  Probability max = pathProbability(parameters, xs, ys);
+
   return Estimation<Labeling<Sequence>>(
       Labeling<Sequence>(xs, std::move(ys)), max);
 }
@@ -524,11 +1027,11 @@ HiddenMarkovModel::posteriorDecoding(const Sequence& xs,
   Sequence path(xs.size());
 
   for (unsigned int i = 0; i < xs.size(); i++) {
-    Probability max = probabilities[0][i];
+    Probability max = probabilities(0, i);
     path[i] = 0;
     for (unsigned int k = 1; k < _state_alphabet_size; k++) {
-      if (probabilities[k][i] > max) {
-        max = probabilities[k][i];
+      if (probabilities(k, i) > max) {
+        max = probabilities(k, i);
         path[i] = k;
       }
     }
@@ -544,27 +1047,676 @@ HiddenMarkovModel::posteriorDecoding(const Sequence& xs,
 
 /*----------------------------------------------------------------------------*/
 
-Probability HiddenMarkovModel::forward(const Sequence& seq,
-                                       Matrix& alpha) const {
-  alpha = Matrix(_state_alphabet_size, std::vector<Probability>(seq.size()));
+Estimation<Labeling<Sequence>>
+HiddenMarkovModel::checkpointedViterbi(const Sequence& xs) const {
+  auto compiled = this->parameters();
+  const auto& parameters = *compiled;
+
+  unsigned int length = xs.size();
+  auto interval = std::max(1u,
+    static_cast<unsigned int>(std::ceil(std::sqrt(length))));
+
+  // Forward pass: keep one column of every `interval` positions
+  Matrix checkpoints(_state_alphabet_size, (length - 1) / interval + 1);
+  Matrix gamma(_state_alphabet_size, 2);
+  IndexMatrix discarded(_state_alphabet_size, 1);
 
   for (unsigned int k = 0; k < _state_alphabet_size; k++)
-    alpha[k][0] = _initial_probabilities->probabilityOf(k)
-      * _states[k]->emission()->probabilityOf(seq[0]);
+    gamma(k, 0) = parameters.initials[k] * parameters.emissions(k, xs[0]);
+
+  for (unsigned int i = 0; i < length; i++) {
+    if (i % interval == 0)
+      for (unsigned int k = 0; k < _state_alphabet_size; k++)
+        checkpoints(k, i / interval) = gamma(k, i % 2);
+    if (i + 1 < length)
+      viterbiColumn(parameters, gamma.column(i % 2), xs[i+1],
+                    gamma.column((i+1) % 2), discarded.column(0));
+  }
 
-  for (unsigned int t = 0; t < seq.size() - 1; t++) {
-    for (unsigned int i = 0; i < _state_alphabet_size; i++) {
-      for (unsigned int j = 0; j < _state_alphabet_size; j++) {
-        alpha[i][t+1] +=
-          alpha[j][t] * _states[j]->transition()->probabilityOf(i);
+  Sequence ys(length);
+  ys[length - 1] = 0;
+  Probability max = gamma(0, (length - 1) % 2);
+  for (unsigned int k = 1; k < _state_alphabet_size; k++) {
+    if (max < gamma(k, (length - 1) % 2)) {
+      max = gamma(k, (length - 1) % 2);
+      ys[length - 1] = k;
+    }
+  }
+
+  // Traceback: recompute the backpointers of each segment, from the last
+  Matrix segment(_state_alphabet_size, interval + 1);
+  IndexMatrix psi(_state_alphabet_size, interval + 1);
+
+  for (int c = (length - 1) / interval; c >= 0; c--) {
+    unsigned int begin = c * interval;
+    unsigned int end = std::min(begin + interval, length - 1);
+
+    for (unsigned int k = 0; k < _state_alphabet_size; k++)
+      segment(k, 0) = checkpoints(k, c);
+
+    for (unsigned int i = begin; i < end; i++)
+      viterbiColumn(parameters, segment.column(i - begin), xs[i+1],
+                    segment.column(i - begin + 1),
+                    psi.column(i - begin + 1));
+
+    for (unsigned int i = end; i > begin; i--)
+      ys[i-1] = psi(ys[i], i - begin);
+  }
+
+  return Estimation<Labeling<Sequence>>(
+      Labeling<Sequence>(xs, std::move(ys)), max);
+}
+
+/*----------------------------------------------------------------------------*/
+
+Estimation<Labeling<Sequence>>
+HiddenMarkovModel::checkpointedPosteriorDecoding(const Sequence& xs) const {
+  auto compiled = this->parameters();
+  const auto& parameters = *compiled;
+
+  unsigned int length = xs.size();
+  auto interval = std::max(1u,
+    static_cast<unsigned int>(std::ceil(std::sqrt(length))));
+
+  // Forward pass: keep one column of every `interval` positions
+  Matrix checkpoints(_state_alphabet_size, (length - 1) / interval + 1);
+  Matrix alpha(_state_alphabet_size, 2);
+
+  for (unsigned int k = 0; k < _state_alphabet_size; k++)
+    alpha(k, 0) = parameters.initials[k] * parameters.emissions(k, xs[0]);
+
+  for (unsigned int i = 0; i < length; i++) {
+    if (i % interval == 0)
+      for (unsigned int k = 0; k < _state_alphabet_size; k++)
+        checkpoints(k, i / interval) = alpha(k, i % 2);
+    if (i + 1 < length)
+      forwardColumn(parameters, alpha.column(i % 2), xs[i+1],
+                    alpha.column((i+1) % 2));
+  }
+
+  Probability full = 0;
+  for (unsigned int k = 0; k < _state_alphabet_size; k++)
+    full += alpha(k, (length - 1) % 2);
+
+  // Backward pass: recompute the forward columns of each segment
+  Matrix segment(_state_alphabet_size, interval);
+  Matrix beta(_state_alphabet_size, 2);
+  Sequence path(length);
+
+  for (unsigned int k = 0; k < _state_alphabet_size; k++)
+    beta(k, (length - 1) % 2) = 1.0;
+
+  for (int c = (length - 1) / interval; c >= 0; c--) {
+    unsigned int begin = c * interval;
+    unsigned int end = std::min(begin + interval, length);
+
+    for (unsigned int k = 0; k < _state_alphabet_size; k++)
+      segment(k, 0) = checkpoints(k, c);
+
+    for (unsigned int i = begin + 1; i < end; i++)
+      forwardColumn(parameters, segment.column(i - begin - 1), xs[i],
+                    segment.column(i - begin));
+
+    for (unsigned int i = end; i-- > begin; ) {
+      if (i + 1 < length)
+        backwardColumn(parameters, beta.column((i+1) % 2), xs[i+1],
+                       beta.column(i % 2));
+
+      Probability max = (segment(0, i - begin) * beta(0, i % 2)) / full;
+      path[i] = 0;
+      for (unsigned int k = 1; k < _state_alphabet_size; k++) {
+        Probability posterior
+          = (segment(k, i - begin) * beta(k, i % 2)) / full;
+        if (posterior > max) {
+          max = posterior;
+          path[i] = k;
+        }
+      }
+    }
+  }
+
+  auto labeling = Labeling<Sequence>(xs, std::move(path));
+  auto probability
+    = const_cast<HiddenMarkovModel*>(this)
+        ->labelingEvaluator(labeling)->evaluateSequence(0, xs.size());
+
+  return Estimation<Labeling<Sequence>>(labeling, probability);
+}
+
+/*----------------------------------------------------------------------------*/
+
+Estimation<Labeling<Sequence>>
+HiddenMarkovModel::fusedPosteriorDecoding(const Sequence& xs,
+                                          Posteriors& posteriors) const {
+  auto compiled = this->parameters();
+  const auto& parameters = *compiled;
+
+  unsigned int length = xs.size();
+
+  Matrix alpha;
+  Probability full = forward(xs, alpha);
+
+  posteriors.probabilities.reset(posteriors.states.size(), length);
+  posteriors.max_posteriors.resize(length);
+
+  // Backward pass: each posterior column is used as soon as it is computed
+  Matrix beta(_state_alphabet_size, 2);
+  Sequence path(length);
+
+  for (unsigned int k = 0; k < _state_alphabet_size; k++)
+    beta(k, (length - 1) % 2) = 1.0;
+
+  for (unsigned int i = length; i-- > 0; ) {
+    if (i + 1 < length)
+      backwardColumn(parameters, beta.column((i+1) % 2), xs[i+1],
+                     beta.column(i % 2));
+
+    Probability max = (alpha(0, i) * beta(0, i % 2)) / full;
+    path[i] = 0;
+    for (unsigned int k = 1; k < _state_alphabet_size; k++) {
+      Probability posterior = (alpha(k, i) * beta(k, i % 2)) / full;
+      if (posterior > max) {
+        max = posterior;
+        path[i] = k;
+      }
+    }
+    posteriors.max_posteriors[i] = max;
+
+    for (unsigned int r = 0; r < posteriors.states.size(); r++) {
+      auto k = posteriors.states[r];
+      posteriors.probabilities(r, i) = (alpha(k, i) * beta(k, i % 2)) / full;
+    }
+  }
+
+  // The path is scored straight from the tables, without an evaluator
+  auto probability = pathProbability(parameters, xs, path);
+
+  return Estimation<Labeling<Sequence>>(
+      Labeling<Sequence>(xs, std::move(path)), probability);
+}
+
+/*----------------------------------------------------------------------------*/
+
+Estimation<Labeling<Sequence>>
+HiddenMarkovModel::beamViterbi(const Sequence& xs, Beam& beam) const {
+  auto compiled = this->parameters();
+  const auto& parameters = *compiled;
+  const auto& log_transitions = parameters.log_transitions;
+  const auto& log_emissions = parameters.log_emissions;
+  const auto& outgoing = parameters.outgoing;
+
+  const double impossible = -std::numeric_limits<double>::infinity();
+
+  beam.cells = 0;
+  beam.pruned_cells = 0;
+  beam.score_loss_bound = 0;
+
+  std::vector<double> previous(_state_alphabet_size);
+  std::vector<double> current(_state_alphabet_size);
+  IndexMatrix psi(_state_alphabet_size, xs.size());
+
+  // Best score of a state left out of the beam, for each position
+  std::vector<double> best_pruned(xs.size(), impossible);
+
+  std::vector<unsigned int> active;
+  std::vector<unsigned int> candidates;
+
+  auto prune = [&] (const std::vector<double>& scores, unsigned int i) {
+    double max = *std::max_element(scores.begin(), scores.end());
+
+    // Unreachable states are not extended by the exact algorithm either
+    std::size_t reachable = 0;
+    candidates.clear();
+    for (unsigned int k = 0; k < _state_alphabet_size; k++) {
+      if (scores[k] == impossible) continue;
+      reachable++;
+      if (scores[k] >= max - beam.margin) candidates.push_back(k);
+    }
+
+    if (beam.width != 0 && candidates.size() > beam.width) {
+      std::nth_element(candidates.begin(),
+                       candidates.begin() + beam.width - 1,
+                       candidates.end(),
+                       [&] (unsigned int a, unsigned int b) {
+                         return scores[a] > scores[b];
+                       });
+      candidates.resize(beam.width);
+    }
+
+    // States are extended in increasing order, so that ties are broken
+    // as in the exact algorithm
+    std::sort(candidates.begin(), candidates.end());
+
+    for (unsigned int k = 0, c = 0; k < _state_alphabet_size; k++) {
+      if (c < candidates.size() && candidates[c] == k)
+        c++;
+      else
+        best_pruned[i] = std::max(best_pruned[i], scores[k]);
+    }
+
+    beam.cells += reachable;
+    beam.pruned_cells += reachable - candidates.size();
+    std::swap(active, candidates);
+  };
+
+  for (unsigned int k = 0; k < _state_alphabet_size; k++)
+    previous[k] = parameters.log_initials[k] + log_emissions(k, xs[0]);
+  prune(previous, 0);
+
+  for (unsigned int i = 1; i < xs.size(); i++) {
+    std::fill(current.begin(), current.end(), impossible);
+
+    for (auto p : active) {
+      if (parameters.sparse) {
+        for (unsigned int e = outgoing.offsets[p];
+             e < outgoing.offsets[p+1]; e++) {
+          unsigned int k = outgoing.states[e];
+          double v = previous[p] + log_transitions(p, k);
+          if (v > current[k]) {
+            current[k] = v;
+            psi(k, i) = p;
+          }
+        }
+      } else {
+        for (unsigned int k = 0; k < _state_alphabet_size; k++) {
+          double v = previous[p] + log_transitions(p, k);
+          if (v > current[k]) {
+            current[k] = v;
+            psi(k, i) = p;
+          }
+        }
+      }
+    }
+
+    for (unsigned int k = 0; k < _state_alphabet_size; k++)
+      current[k] += log_emissions(k, xs[i]);
+
+    prune(current, i);
+    std::swap(previous, current);
+  }
+
+  Sequence ys(xs.size());
+  ys[xs.size() - 1] = active.empty() ? 0 : active.front();
+  for (auto k : active)
+    if (previous[ys[xs.size() - 1]] < previous[k])
+      ys[xs.size() - 1] = k;
+  for (int i = xs.size() - 1; i >= 1; i--)
+    ys[i-1] = psi(ys[i], i);
+
+  if (beam.bounded) {
+    // Optimistic completion: the best transition into and emission
+    // of any state, for each of the remaining positions
+    std::vector<double> best_incoming(_state_alphabet_size, impossible);
+    for (unsigned int p = 0; p < _state_alphabet_size; p++)
+      for (unsigned int k = 0; k < _state_alphabet_size; k++)
+        best_incoming[k] = std::max(best_incoming[k], log_transitions(p, k));
+
+    double best = previous[ys[xs.size() - 1]];
+    double completion = 0;
+    double bound = best;
+    for (int i = xs.size() - 1; i >= 0; i--) {
+      bound = std::max(bound, best_pruned[i] + completion);
+
+      double step = impossible;
+      for (unsigned int k = 0; k < _state_alphabet_size; k++)
+        step = std::max(step, best_incoming[k] + log_emissions(k, xs[i]));
+      completion += step;
+    }
+
+    beam.score_loss_bound = bound - best;
+  }
+
+  return Estimation<Labeling<Sequence>>(
+      Labeling<Sequence>(xs, ys), pathProbability(parameters, xs, ys));
+}
+
+/*----------------------------------------------------------------------------*/
+
+Estimation<Labeling<Sequence>>
+HiddenMarkovModel::listViterbi(const Sequence& xs, NBest& nbest) const {
+  auto compiled = this->parameters();
+  const auto& parameters = *compiled;
+  const auto& incoming = parameters.incoming;
+
+  unsigned int length = xs.size();
+  unsigned int n = _state_alphabet_size;
+  unsigned int size = std::max(1u, nbest.size);
+
+  // Path r of state k is kept in row k * size + r, and points to
+  // the path q of its predecessor p as p * size + q
+  Matrix scores(n * size, 2);
+  IndexMatrix counts(n, 2);
+  IndexMatrix psi(n * size, length);
+
+  for (unsigned int k = 0; k < n; k++) {
+    scores(k * size, 0)
+      = parameters.initials[k] * parameters.emissions(k, xs[0]);
+    counts(k, 0) = 1;
+  }
+
+  // The best paths of a cell are merged from the sorted lists of its
+  // predecessors, with a heap holding one candidate per predecessor
+  std::vector<PathCandidate> heap;
+
+  for (unsigned int i = 1; i < length; i++) {
+    unsigned int previous = (i - 1) % 2, current = i % 2;
+
+    for (unsigned int k = 0; k < n; k++) {
+      counts(k, current) = 0;
+      Probability emission = parameters.emissions(k, xs[i]);
+      if (!(Probability(0) < emission)) continue;
+
+      heap.clear();
+      auto candidate = [&] (unsigned int p, const Probability& transition) {
+        if (counts(p, previous) > 0)
+          heap.push_back({ scores(p * size, previous) * transition,
+                           transition, p, 0 });
+      };
+      if (parameters.sparse) {
+        for (unsigned int e = incoming.offsets[k];
+             e < incoming.offsets[k+1]; e++)
+          candidate(incoming.states[e], incoming.probabilities[e]);
+      } else {
+        for (unsigned int p = 0; p < n; p++)
+          candidate(p, parameters.transitions(p, k));
+      }
+      std::make_heap(heap.begin(), heap.end());
+
+      unsigned int r = 0;
+      while (r < size && !heap.empty()) {
+        std::pop_heap(heap.begin(), heap.end());
+        auto best = heap.back();
+        heap.pop_back();
+        if (!(Probability(0) < best.score)) break;
+
+        scores(k * size + r, current) = best.score * emission;
+        psi(k * size + r, i) = best.state * size + best.rank;
+        r++;
+
+        if (best.rank + 1 < counts(best.state, previous)) {
+          heap.push_back({
+            scores(best.state * size + best.rank + 1, previous)
+              * best.transition,
+            best.transition, best.state, best.rank + 1 });
+          std::push_heap(heap.begin(), heap.end());
+        }
+      }
+      counts(k, current) = r;
+    }
+  }
+
+  unsigned int last = (length - 1) % 2;
+
+  heap.clear();
+  for (unsigned int k = 0; k < n; k++)
+    if (counts(k, last) > 0)
+      heap.push_back({ scores(k * size, last), 1, k, 0 });
+  std::make_heap(heap.begin(), heap.end());
+
+  nbest.labelings.clear();
+  while (nbest.labelings.size() < size && !heap.empty()) {
+    std::pop_heap(heap.begin(), heap.end());
+    auto best = heap.back();
+    heap.pop_back();
+    if (!(Probability(0) < best.score)) break;
+
+    Sequence ys(length);
+    unsigned int k = best.state, r = best.rank;
+    for (unsigned int i = length - 1; i > 0; i--) {
+      ys[i] = k;
+      auto packed = psi(k * size + r, i);
+      k = packed / size;
+      r = packed % size;
+    }
+    ys[0] = k;
+
+    nbest.labelings.emplace_back(
+      Labeling<Sequence>(xs, std::move(ys)), best.score);
+
+    if (best.rank + 1 < counts(best.state, last)) {
+      heap.push_back({ scores(best.state * size + best.rank + 1, last),
+                       1, best.state, best.rank + 1 });
+      std::push_heap(heap.begin(), heap.end());
+    }
+  }
+
+  if (nbest.labelings.empty()) return Estimation<Labeling<Sequence>>();
+  return nbest.labelings.front();
+}
+
+/*----------------------------------------------------------------------------*/
+
+Estimation<Labeling<Sequence>>
+HiddenMarkovModel::lazyListViterbi(const Sequence& xs, NBest& nbest) const {
+  auto compiled = this->parameters();
+  const auto& parameters = *compiled;
+  const auto& incoming = parameters.incoming;
+
+  unsigned int length = xs.size();
+  unsigned int n = _state_alphabet_size;
+  unsigned int size = std::max(1u, nbest.size);
+
+  // The best path of each cell comes from the Viterbi algorithm
+  Matrix gamma(n, length);
+  IndexMatrix psi(n, length);
+
+  for (unsigned int k = 0; k < n; k++)
+    gamma(k, 0) = parameters.initials[k] * parameters.emissions(k, xs[0]);
+  for (unsigned int i = 0; i + 1 < length; i++)
+    viterbiColumn(parameters, gamma.column(i), xs[i+1],
+                  gamma.column(i+1), psi.column(i+1));
+
+  // The following paths are derived only for the cells that need them
+  // (recursive enumeration): the next path of a cell is the best among
+  // the paths it has not used yet, and using the path q of a predecessor
+  // makes its path q + 1 a new candidate
+  struct Cell {
+    std::vector<PathCandidate> paths;       // from the second best one
+    std::vector<PathCandidate> candidates;  // heap
+    unsigned int extended = 0;
+    bool initialized = false;
+    bool exhausted = false;
+  };
+  std::unordered_map<std::size_t, Cell> cells;
+
+  auto key = [n] (unsigned int i, unsigned int k) {
+    return static_cast<std::size_t>(i) * n + k;
+  };
+
+  auto path = [&] (unsigned int i, unsigned int k, unsigned int r) {
+    if (r == 0)
+      return PathCandidate{ gamma(k, i), 1, i > 0 ? psi(k, i) : 0, 0 };
+    return cells.at(key(i, k)).paths[r - 1];
+  };
+
+  auto available = [&] (unsigned int i, unsigned int k, unsigned int r) {
+    if (r == 0) return true;
+    auto cell = cells.find(key(i, k));
+    return cell != cells.end() && cell->second.paths.size() >= r;
+  };
+
+  // Derives path r of cell (i, k), with an explicit stack of requests
+  // instead of a recursion as deep as the sequence
+  struct Request { unsigned int i, k, r; };
+  std::vector<Request> requests;
+
+  auto extend = [&] (unsigned int i, unsigned int k, unsigned int r) {
+    requests.assign(1, Request{ i, k, r });
+    while (!requests.empty()) {
+      auto request = requests.back();
+      auto& cell = cells[key(request.i, request.k)];
+
+      if (cell.exhausted || cell.paths.size() >= request.r) {
+        requests.pop_back();
+        continue;
       }
-      alpha[i][t+1] *= _states[i]->emission()->probabilityOf(seq[t+1]);
+      if (request.i == 0) {
+        cell.exhausted = true;
+        requests.pop_back();
+        continue;
+      }
+
+      unsigned int pi = request.i - 1, state = request.k;
+      if (!cell.initialized) {
+        auto candidate = [&] (unsigned int p, const Probability& transition) {
+          if (p != psi(state, request.i))
+            cell.candidates.push_back({ gamma(p, pi) * transition,
+                                        transition, p, 0 });
+        };
+        if (parameters.sparse) {
+          for (unsigned int e = incoming.offsets[state];
+               e < incoming.offsets[state+1]; e++)
+            candidate(incoming.states[e], incoming.probabilities[e]);
+        } else {
+          for (unsigned int p = 0; p < n; p++)
+            candidate(p, parameters.transitions(p, state));
+        }
+        std::make_heap(cell.candidates.begin(), cell.candidates.end());
+        cell.initialized = true;
+      }
+
+      if (cell.extended < request.r) {
+        auto used = path(request.i, state, request.r - 1);
+        auto transition = parameters.transitions(used.state, state);
+        auto& predecessor = cells[key(pi, used.state)];
+
+        if (!available(pi, used.state, used.rank + 1)
+            && !predecessor.exhausted) {
+          requests.push_back(Request{ pi, used.state, used.rank + 1 });
+          continue;
+        }
+        if (available(pi, used.state, used.rank + 1)) {
+          cell.candidates.push_back({
+            path(pi, used.state, used.rank + 1).score * transition,
+            transition, used.state, used.rank + 1 });
+          std::push_heap(cell.candidates.begin(), cell.candidates.end());
+        }
+        cell.extended = request.r;
+      }
+
+      auto& candidates = cell.candidates;
+      if (candidates.empty() || !(Probability(0) < candidates.front().score)) {
+        cell.exhausted = true;
+      } else {
+        std::pop_heap(candidates.begin(), candidates.end());
+        auto best = candidates.back();
+        candidates.pop_back();
+        best.score *= parameters.emissions(state, xs[request.i]);
+        cell.paths.push_back(best);
+      }
+      requests.pop_back();
+    }
+    return available(i, k, r);
+  };
+
+  unsigned int last = length - 1;
+
+  std::vector<PathCandidate> heap;
+  for (unsigned int k = 0; k < n; k++)
+    heap.push_back({ gamma(k, last), 1, k, 0 });
+  std::make_heap(heap.begin(), heap.end());
+
+  nbest.labelings.clear();
+  while (nbest.labelings.size() < size && !heap.empty()) {
+    std::pop_heap(heap.begin(), heap.end());
+    auto best = heap.back();
+    heap.pop_back();
+    if (!(Probability(0) < best.score)) break;
+
+    Sequence ys(length);
+    unsigned int k = best.state, r = best.rank;
+    for (unsigned int i = last; i > 0; i--) {
+      ys[i] = k;
+      auto previous = path(i, k, r);
+      k = previous.state;
+      r = previous.rank;
+    }
+    ys[0] = k;
+
+    nbest.labelings.emplace_back(
+      Labeling<Sequence>(xs, std::move(ys)), best.score);
+
+    if (nbest.labelings.size() < size
+        && extend(last, best.state, best.rank + 1)) {
+      heap.push_back({ path(last, best.state, best.rank + 1).score,
+                       1, best.state, best.rank + 1 });
+      std::push_heap(heap.begin(), heap.end());
     }
   }
 
+  if (nbest.labelings.empty()) return Estimation<Labeling<Sequence>>();
+  return nbest.labelings.front();
+}
+
+/*----------------------------------------------------------------------------*/
+
+std::vector<Estimation<Labeling<Sequence>>>
+HiddenMarkovModel::stochasticTraceback(const Sequence& xs,
+                                       const Matrix& alpha,
+                                       unsigned int number_of_samples,
+                                       RandomNumberGeneratorPtr rng,
+                                       unsigned int number_of_threads) const {
+  auto compiled = this->parameters();
+  const auto& parameters = *compiled;
+  const auto& incoming = parameters.incoming;
+
+  // The state of each position is drawn given the state of the next one,
+  // with weights alpha(p, i-1) * a(p, k) over the predecessors p of k
+  auto traceback = [this, &xs, &alpha, &parameters, &incoming] (
+      RandomNumberGenerator& generator) {
+    unsigned int length = xs.size();
+    Sequence ys(length);
+    std::vector<Probability> weights(_state_alphabet_size);
+
+    for (unsigned int k = 0; k < _state_alphabet_size; k++)
+      weights[k] = alpha(k, length - 1);
+    ys[length - 1] = drawIndex(weights, generator);
+
+    for (unsigned int i = length - 1; i >= 1; i--) {
+      auto k = ys[i];
+      if (parameters.sparse) {
+        weights.clear();
+        for (unsigned int e = incoming.offsets[k];
+             e < incoming.offsets[k+1]; e++)
+          weights.push_back(alpha(incoming.states[e], i - 1)
+                            * incoming.probabilities[e]);
+        ys[i-1] = weights.empty() ? 0
+          : incoming.states[incoming.offsets[k]
+                            + drawIndex(weights, generator)];
+      } else {
+        weights.resize(_state_alphabet_size);
+        for (unsigned int p = 0; p < _state_alphabet_size; p++)
+          weights[p] = alpha(p, i - 1) * parameters.transitions(p, k);
+        ys[i-1] = drawIndex(weights, generator);
+      }
+    }
+
+    Probability probability = pathProbability(parameters, xs, ys);
+    return Estimation<Labeling<Sequence>>(
+        Labeling<Sequence>(xs, std::move(ys)), probability);
+  };
+
+  return drawTracebacks(number_of_samples, rng, number_of_threads, traceback);
+}
+
+/*----------------------------------------------------------------------------*/
+
+Probability HiddenMarkovModel::forward(const Sequence& seq,
+                                       Matrix& alpha) const {
+  auto compiled = this->parameters();
+  const auto& parameters = *compiled;
+
+  alpha.reset(_state_alphabet_size, seq.size());
+
+  for (unsigned int k = 0; k < _state_alphabet_size; k++)
+    alpha(k, 0) = parameters.initials[k] * parameters.emissions(k, seq[0]);
+
+  for (unsigned int t = 0; t < seq.size() - 1; t++)
+    forwardColumn(parameters, alpha.column(t), seq[t+1], alpha.column(t+1));
+
   Probability sum = 0;
   for (unsigned int k = 0; k < _state_alphabet_size; k++)
-    sum += alpha[k][seq.size()-1];
+    sum += alpha(k, seq.size()-1);
 
   return sum;
 }
@@ -573,27 +1725,21 @@ Probability HiddenMarkovModel::forward(const Sequence& seq,
 
 Probability HiddenMarkovModel::backward(const Sequence& seq,
                                         Matrix& beta) const {
-  beta = Matrix(_state_alphabet_size, std::vector<Probability>(seq.size()));
+  auto compiled = this->parameters();
+  const auto& parameters = *compiled;
+
+  beta.reset(_state_alphabet_size, seq.size());
 
   for (unsigned int k = 0; k < _state_alphabet_size; k++)
-    beta[k][seq.size()-1] = 1.0;
+    beta(k, seq.size()-1) = 1.0;
 
-  for (int t = seq.size()-2; t >= 0; t--) {
-    for (unsigned int i = 0; i < _state_alphabet_size; i++) {
-      for (unsigned int j = 0; j < _state_alphabet_size; j++) {
-        beta[i][t] +=
-          _states[i]->transition()->probabilityOf(j)
-          * _states[j]->emission()->probabilityOf(seq[t+1])
-          * beta[j][t+1];
-      }
-    }
-  }
+  for (int t = seq.size()-2; t >= 0; t--)
+    backwardColumn(parameters, beta.column(t+1), seq[t+1], beta.column(t));
 
   Probability sum = 0;
   for (unsigned int k = 0; k < _state_alphabet_size; k++) {
-    sum += beta[k][0]
-      * _initial_probabilities->probabilityOf(k)
-      * _states[k]->emission()->probabilityOf(seq[0]);
+    sum += beta(k, 0)
+      * parameters.initials[k] * parameters.emissions(k, seq[0]);
   }
 
   return sum;
@@ -601,5 +1747,110 @@ Probability HiddenMarkovModel::backward(const Sequence& seq,
 
 /*----------------------------------------------------------------------------*/
 
+Probability HiddenMarkovModel::pathProbability(const Parameters& parameters,
+                                               const Sequence& xs,
+                                               const Sequence& ys) const {
+  Probability probability
+    = parameters.initials[ys[0]] * parameters.emissions(ys[0], xs[0]);
+  for (unsigned int i = 1; i < xs.size(); i++)
+    probability *= parameters.transitions(ys[i-1], ys[i])
+                 * parameters.emissions(ys[i], xs[i]);
+  return probability;
+}
+
+/*----------------------------------------------------------------------------*/
+
+void HiddenMarkovModel::viterbiColumn(const Parameters& parameters,
+                                      Matrix::ConstView previous,
+                                      Symbol symbol,
+                                      Matrix::View current,
+                                      IndexMatrix::View backpointers) const {
+  const auto& transitions = parameters.transitions;
+  const auto& incoming = parameters.incoming;
+
+  for (unsigned int k = 0; k < _state_alphabet_size; k++) {
+    if (parameters.sparse) {
+      current[k] = 0;
+      backpointers[k] = 0;
+      for (unsigned int e = incoming.offsets[k];
+           e < incoming.offsets[k+1]; e++) {
+        Probability v = previous[incoming.states[e]]
+                      * incoming.probabilities[e];
+        if (current[k] < v) {
+          current[k] = v;
+          backpointers[k] = incoming.states[e];
+        }
+      }
+    } else {
+      current[k] = previous[0] * transitions(0, k);
+      backpointers[k] = 0;
+      for (unsigned int p = 1; p < _state_alphabet_size; p++) {
+        Probability v = previous[p] * transitions(p, k);
+        if (current[k] < v) {
+          current[k] = v;
+          backpointers[k] = p;
+        }
+      }
+    }
+    current[k] *= parameters.emissions(k, symbol);
+  }
+}
+
+/*----------------------------------------------------------------------------*/
+
+void HiddenMarkovModel::forwardColumn(const Parameters& parameters,
+                                      Matrix::ConstView previous,
+                                      Symbol symbol,
+                                      Matrix::View current) const {
+  const auto& transitions = parameters.transitions;
+  const auto& incoming = parameters.incoming;
+
+  for (unsigned int i = 0; i < _state_alphabet_size; i++) {
+    current[i] = 0;
+    if (parameters.sparse) {
+      for (unsigned int e = incoming.offsets[i];
+           e < incoming.offsets[i+1]; e++)
+        current[i] += previous[incoming.states[e]]
+                    * incoming.probabilities[e];
+    } else {
+      for (unsigned int j = 0; j < _state_alphabet_size; j++)
+        current[i] += previous[j] * transitions(j, i);
+    }
+    current[i] *= parameters.emissions(i, symbol);
+  }
+}
+
+/*----------------------------------------------------------------------------*/
+
+void HiddenMarkovModel::backwardColumn(const Parameters& parameters,
+                                       Matrix::ConstView next,
+                                       Symbol next_symbol,
+                                       Matrix::View current) const {
+  const auto& transitions = parameters.transitions;
+  const auto& emissions = parameters.emissions;
+  const auto& outgoing = parameters.outgoing;
+
+  for (unsigned int i = 0; i < _state_alphabet_size; i++) {
+    current[i] = 0;
+    if (parameters.sparse) {
+      for (unsigned int e = outgoing.offsets[i];
+           e < outgoing.offsets[i+1]; e++) {
+        unsigned int j = outgoing.states[e];
+        current[i] += outgoing.probabilities[e]
+          * emissions(j, next_symbol)
+          * next[j];
+      }
+    } else {
+      for (unsigned int j = 0; j < _state_alphabet_size; j++) {
+        current[i] += transitions(i, j)
+          * emissions(j, next_symbol)
+          * next[j];
+      }
+    }
+  }
+}
+
+/*----------------------------------------------------------------------------*/
+
 }  // namespace model
 }  // namespace tops
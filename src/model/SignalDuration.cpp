@@ -48,6 +48,12 @@ RangePtr SignalDuration::range() const {
 
 /*----------------------------------------------------------------------------*/
 
+DurationSupport SignalDuration::support() const {
+  return DurationSupport(_duration_size, _duration_size);
+}
+
+/*----------------------------------------------------------------------------*/
+
 unsigned int SignalDuration::maximumSize() const {
   return _duration_size;
 }
@@ -61,5 +67,12 @@ Probability SignalDuration::probabilityOfLenght(unsigned int length) const {
 
 /*----------------------------------------------------------------------------*/
 
+Probability SignalDuration::survival(unsigned int length) const {
+  if (length <= _duration_size) return 1;
+  return 0;
+}
+
+/*----------------------------------------------------------------------------*/
+
 }  // namespace model
 }  // namespace tops
@@ -0,0 +1,259 @@
+/***********************************************************************/
+/*  Copyright 2015 ToPS                                                */
+/*                                                                     */
+/*  This program is free software; you can redistribute it and/or      */
+/*  modify it under the terms of the GNU  General Public License as    */
+/*  published by the Free Software Foundation; either version 3 of     */
+/*  the License, or (at your option) any later version.                */
+/*                                                                     */
+/*  This program is distributed in the hope that it will be useful,    */
+/*  but WITHOUT ANY WARRANTY; without even the implied warranty of     */
+/*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the      */
+/*  GNU General Public License for more details.                       */
+/*                                                                     */
+/*  You should have received a copy of the GNU General Public License  */
+/*  along with this program; if not, write to the Free Software        */
+/*  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,         */
+/*  MA 02110-1301, USA.                                                */
+/***********************************************************************/
+
+// Interface header
+#include "model/Simulator.hpp"
+
+// Standard headers
+#include <random>
+#include <cstdint>
+#include <utility>
+#include <algorithm>
+
+// Internal headers
+#include "model/ThreadPool.hpp"
+#include "model/DiscreteIIDModel.hpp"
+#include "model/RandomNumberGeneratorAdapter.hpp"
+
+#include "exception/InvalidModelDefinition.hpp"
+
+namespace tops {
+namespace model {
+
+/*----------------------------------------------------------------------------*/
+/*                              STATIC METHODS                                */
+/*----------------------------------------------------------------------------*/
+
+SimulatorPtr Simulator::make(HiddenMarkovModelPtr model) {
+  auto compiled = model->parameters();
+  const auto& parameters = *compiled;
+  auto states = model->stateAlphabetSize();
+  auto symbols = model->observationAlphabetSize();
+
+  auto simulator = SimulatorPtr(new Simulator());
+  simulator->_initials = aliasTable(parameters.initials);
+  simulator->_states.resize(states);
+
+  std::vector<Probability> row;
+  for (unsigned int k = 0; k < states; k++) {
+    auto& tables = simulator->_states[k];
+
+    row.assign(states, Probability(0));
+    for (unsigned int l = 0; l < states; l++)
+      row[l] = parameters.transitions(k, l);
+    tables.transition = aliasTable(row);
+
+    row.assign(symbols, Probability(0));
+    for (unsigned int s = 0; s < symbols; s++)
+      row[s] = parameters.emissions(k, s);
+    tables.emission = aliasTable(row);
+
+    tables.duration = aliasTable({ 1 }, { 1.0 });
+  }
+
+  return simulator;
+}
+
+/*----------------------------------------------------------------------------*/
+
+SimulatorPtr Simulator::make(GeneralizedHiddenMarkovModelPtr model) {
+  auto simulator = SimulatorPtr(new Simulator());
+  simulator->_initials
+    = aliasTable(model->_initial_probabilities->probabilities());
+  simulator->_states.resize(model->_states.size());
+
+  std::vector<unsigned int> lengths;
+  std::vector<double> probabilities;
+  for (unsigned int k = 0; k < model->_states.size(); k++) {
+    auto& state = model->_states[k];
+    auto& tables = simulator->_states[k];
+
+    tables.transition = aliasTable(state->transition()->probabilities());
+
+    lengths.clear();
+    probabilities.clear();
+    for (auto d : state->duration()->support()) {
+      lengths.push_back(d);
+      probabilities.push_back(
+        static_cast<double>(state->duration()->probabilityOfLenght(d)));
+    }
+    tables.duration = aliasTable(lengths, probabilities);
+
+    auto emission
+      = std::dynamic_pointer_cast<DiscreteIIDModel>(state->emission());
+    if (emission)
+      tables.emission = aliasTable(emission->probabilities());
+    else
+      tables.emission_model = state->emission();
+  }
+
+  return simulator;
+}
+
+/*----------------------------------------------------------------------------*/
+
+unsigned int Simulator::streamSeed(unsigned int seed, std::size_t stream) {
+  auto index = static_cast<std::uint64_t>(stream);
+  std::seed_seq sequence {
+    seed,
+    static_cast<unsigned int>(index & 0xFFFFFFFF),
+    static_cast<unsigned int>(index >> 32) };
+
+  std::uint32_t stream_seed;
+  sequence.generate(&stream_seed, &stream_seed + 1);
+  return stream_seed;
+}
+
+/*----------------------------------------------------------------------------*/
+/*                             CONCRETE METHODS                               */
+/*----------------------------------------------------------------------------*/
+
+void Simulator::draw(std::size_t size,
+                     RandomNumberGeneratorPtr rng,
+                     Labeling<Sequence>& buffer) const {
+  auto& observation = buffer.observation();
+  auto& label = buffer.label();
+
+  observation.resize(size);
+  label.resize(size);
+  buffer.other_observations().clear();
+  if (size == 0) return;
+
+  auto& random = *rng;
+  unsigned int state = draw(_initials, random);
+
+  for (std::size_t begin = 0; ; ) {
+    const auto& tables = _states[state];
+    std::size_t end = std::min<std::size_t>(
+      size, begin + draw(tables.duration, random));
+
+    std::fill(label.begin() + begin, label.begin() + end, state);
+
+    if (tables.emission_model) {
+      Sequence segment = tables.emission_model->standardGenerator(rng)
+                           ->drawSequence(end - begin);
+      std::copy(segment.begin(), segment.end(), observation.begin() + begin);
+    } else {
+      for (std::size_t i = begin; i < end; i++)
+        observation[i] = draw(tables.emission, random);
+    }
+
+    if (end == size) break;
+
+    begin = end;
+    state = draw(tables.transition, random);
+  }
+}
+
+/*----------------------------------------------------------------------------*/
+
+std::vector<Labeling<Sequence>> Simulator::simulate(
+    std::size_t number_of_sequences,
+    std::size_t size,
+    unsigned int seed,
+    unsigned int number_of_threads) const {
+  std::vector<Labeling<Sequence>> labelings(number_of_sequences);
+  simulate(labelings, size, seed, number_of_threads);
+  return labelings;
+}
+
+/*----------------------------------------------------------------------------*/
+
+void Simulator::simulate(std::vector<Labeling<Sequence>>& buffers,
+                         std::size_t size,
+                         unsigned int seed,
+                         unsigned int number_of_threads) const {
+  auto pool = ThreadPool::make(number_of_threads);
+  pool->parallelFor(buffers.size(), [&](std::size_t i, unsigned int) {
+    auto rng = RNGAdapter<std::mt19937>::make(streamSeed(seed, i));
+    draw(size, rng, buffers[i]);
+  });
+}
+
+/*----------------------------------------------------------------------------*/
+
+auto Simulator::aliasTable(const std::vector<unsigned int>& outcomes,
+                           const std::vector<double>& probabilities)
+    -> AliasTable {
+  AliasTable table;
+
+  double total = 0;
+  for (std::size_t i = 0; i < outcomes.size(); i++) {
+    if (probabilities[i] <= 0) continue;
+    table.outcomes.push_back(outcomes[i]);
+    table.thresholds.push_back(probabilities[i]);
+    total += probabilities[i];
+  }
+
+  auto n = table.outcomes.size();
+  table.aliases = table.outcomes;
+
+  // Vose's method: pair each outcome below the mean with one above it
+  std::vector<std::size_t> small, large;
+  for (std::size_t i = 0; i < n; i++) {
+    table.thresholds[i] *= n / total;
+    (table.thresholds[i] < 1 ? small : large).push_back(i);
+  }
+
+  while (!small.empty() && !large.empty()) {
+    auto s = small.back(); small.pop_back();
+    auto l = large.back(); large.pop_back();
+
+    table.aliases[s] = table.outcomes[l];
+    table.thresholds[l] -= 1 - table.thresholds[s];
+    (table.thresholds[l] < 1 ? small : large).push_back(l);
+  }
+
+  // Leftovers differ from 1 only by rounding errors
+  for (auto i : small) table.thresholds[i] = 1;
+  for (auto i : large) table.thresholds[i] = 1;
+
+  return table;
+}
+
+/*----------------------------------------------------------------------------*/
+
+auto Simulator::aliasTable(const std::vector<Probability>& probabilities)
+    -> AliasTable {
+  std::vector<unsigned int> outcomes(probabilities.size());
+  std::vector<double> linear(probabilities.size());
+  for (unsigned int i = 0; i < probabilities.size(); i++) {
+    outcomes[i] = i;
+    linear[i] = static_cast<double>(probabilities[i]);
+  }
+  return aliasTable(outcomes, linear);
+}
+
+/*----------------------------------------------------------------------------*/
+
+unsigned int Simulator::draw(const AliasTable& table,
+                             RandomNumberGenerator& rng) {
+  auto n = table.outcomes.size();
+  if (n == 0) throw_exception(InvalidModelDefinition);
+  if (n == 1) return table.outcomes[0];
+
+  double u = rng.generateDoubleInUnitInterval() * n;
+  auto i = std::min(static_cast<std::size_t>(u), n - 1);
+  return (u - i < table.thresholds[i]) ? table.outcomes[i] : table.aliases[i];
+}
+
+/*----------------------------------------------------------------------------*/
+
+}  // namespace model
+}  // namespace tops
@@ -0,0 +1,201 @@
+/***********************************************************************/
+/*  Copyright 2015 ToPS                                                */
+/*                                                                     */
+/*  This program is free software; you can redistribute it and/or      */
+/*  modify it under the terms of the GNU  General Public License as    */
+/*  published by the Free Software Foundation; either version 3 of     */
+/*  the License, or (at your option) any later version.                */
+/*                                                                     */
+/*  This program is distributed in the hope that it will be useful,    */
+/*  but WITHOUT ANY WARRANTY; without even the implied warranty of     */
+/*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the      */
+/*  GNU General Public License for more details.                       */
+/*                                                                     */
+/*  You should have received a copy of the GNU General Public License  */
+/*  along with this program; if not, write to the Free Software        */
+/*  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,         */
+/*  MA 02110-1301, USA.                                                */
+/***********************************************************************/
+
+// Interface header
+#include "model/StreamingViterbi.hpp"
+
+// Standard headers
+#include <utility>
+#include <algorithm>
+
+namespace tops {
+namespace model {
+
+/*----------------------------------------------------------------------------*/
+/*                               CONSTRUCTORS                                 */
+/*----------------------------------------------------------------------------*/
+
+StreamingViterbi::StreamingViterbi(HiddenMarkovModelPtr model,
+                                   unsigned int lag)
+    : _model(std::move(model)), _parameters(_model->parameters()),
+      _lag(std::max(1u, lag)) {
+  auto states = _model->stateAlphabetSize();
+
+  _gamma = Matrix(states, 2);
+  _psi = IndexMatrix(states, _lag);
+  _alive.resize(states);
+  _ancestors.resize(states);
+}
+
+/*----------------------------------------------------------------------------*/
+/*                              STATIC METHODS                                */
+/*----------------------------------------------------------------------------*/
+
+StreamingViterbiPtr StreamingViterbi::make(HiddenMarkovModelPtr model,
+                                           unsigned int lag) {
+  return StreamingViterbiPtr(new StreamingViterbi(std::move(model), lag));
+}
+
+/*----------------------------------------------------------------------------*/
+/*                             CONCRETE METHODS                               */
+/*----------------------------------------------------------------------------*/
+
+Sequence StreamingViterbi::push(const Sequence& symbols) {
+  Sequence labels;
+
+  for (auto symbol : symbols) {
+    read(symbol);
+
+    // Fixed lag: the oldest label cannot wait for another symbol
+    if (_position - _committed > _lag)
+      commit(_committed + 1,
+             trace(bestState(), _position - 1, _committed), labels);
+  }
+
+  converge(labels);
+  return labels;
+}
+
+/*----------------------------------------------------------------------------*/
+
+Sequence StreamingViterbi::finish() {
+  Sequence labels;
+  if (_committed < _position) commit(_position, bestState(), labels);
+
+  _position = 0;
+  _committed = 0;
+
+  return labels;
+}
+
+/*----------------------------------------------------------------------------*/
+
+std::size_t StreamingViterbi::position() const {
+  return _position;
+}
+
+/*----------------------------------------------------------------------------*/
+
+std::size_t StreamingViterbi::committed() const {
+  return _committed;
+}
+
+/*----------------------------------------------------------------------------*/
+
+void StreamingViterbi::read(Symbol symbol) {
+  const auto& parameters = *_parameters;
+  auto current = _gamma.column(_position % 2);
+
+  if (_position == 0) {
+    for (unsigned int k = 0; k < current.size(); k++)
+      current[k] = parameters.initials[k] * parameters.emissions(k, symbol);
+  } else {
+    _model->viterbiColumn(parameters, _gamma.column((_position - 1) % 2),
+                          symbol, current, _psi.column(_position % _lag));
+  }
+
+  // Scores are kept relative to the best one, so that they do not drift
+  // out of the precision of a double however long the stream is
+  Probability max = current[0];
+  for (unsigned int k = 1; k < current.size(); k++)
+    if (max < current[k]) max = current[k];
+  if (max > Probability(0))
+    for (auto& score : current) score /= max;
+
+  _position++;
+}
+
+/*----------------------------------------------------------------------------*/
+
+void StreamingViterbi::converge(Sequence& labels) {
+  if (_committed == _position) return;
+
+  auto last = _gamma.column((_position - 1) % 2);
+
+  unsigned int survivors = 0;
+  unsigned int state = 0;
+  for (unsigned int k = 0; k < last.size(); k++) {
+    _alive[k] = last[k] > Probability(0);
+    if (_alive[k]) { survivors++; state = k; }
+  }
+
+  // Follow all paths alive back together, until they merge into one
+  auto position = _position - 1;
+  while (survivors > 1 && position > _committed) {
+    std::fill(_ancestors.begin(), _ancestors.end(), 0);
+    survivors = 0;
+    for (unsigned int k = 0; k < _alive.size(); k++) {
+      if (!_alive[k]) continue;
+      auto ancestor = _psi(k, position % _lag);
+      if (!_ancestors[ancestor]) {
+        _ancestors[ancestor] = 1;
+        survivors++;
+        state = ancestor;
+      }
+    }
+    std::swap(_alive, _ancestors);
+    position--;
+  }
+
+  if (survivors == 1) commit(position + 1, state, labels);
+}
+
+/*----------------------------------------------------------------------------*/
+
+void StreamingViterbi::commit(std::size_t end,
+                              unsigned int state,
+                              Sequence& labels) {
+  // `state` is the label of position end - 1
+  auto offset = labels.size();
+  labels.resize(offset + end - _committed);
+
+  for (auto i = end - 1; i > _committed; i--) {
+    labels[offset + i - _committed] = state;
+    state = _psi(state, i % _lag);
+  }
+  labels[offset] = state;
+
+  _committed = end;
+}
+
+/*----------------------------------------------------------------------------*/
+
+unsigned int StreamingViterbi::trace(unsigned int state,
+                                     std::size_t from,
+                                     std::size_t to) const {
+  for (auto i = from; i > to; i--) state = _psi(state, i % _lag);
+  return state;
+}
+
+/*----------------------------------------------------------------------------*/
+
+unsigned int StreamingViterbi::bestState() const {
+  auto last = _gamma.column((_position - 1) % 2);
+
+  unsigned int best = 0;
+  for (unsigned int k = 1; k < last.size(); k++)
+    if (last[best] < last[k]) best = k;
+
+  return best;
+}
+
+/*----------------------------------------------------------------------------*/
+
+}  // namespace model
+}  // namespace tops
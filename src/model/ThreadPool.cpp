@@ -0,0 +1,159 @@
+/***********************************************************************/
+/*  Copyright 2015 ToPS                                                */
+/*                                                                     */
+/*  This program is free software; you can redistribute it and/or      */
+/*  modify it under the terms of the GNU  General Public License as    */
+/*  published by the Free Software Foundation; either version 3 of     */
+/*  the License, or (at your option) any later version.                */
+/*                                                                     */
+/*  This program is distributed in the hope that it will be useful,    */
+/*  but WITHOUT ANY WARRANTY; without even the implied warranty of     */
+/*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the      */
+/*  GNU General Public License for more details.                       */
+/*                                                                     */
+/*  You should have received a copy of the GNU General Public License  */
+/*  along with this program; if not, write to the Free Software        */
+/*  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,         */
+/*  MA 02110-1301, USA.                                                */
+/***********************************************************************/
+
+// Interface header
+#include "model/ThreadPool.hpp"
+
+// Standard headers
+#include <algorithm>
+
+namespace tops {
+namespace model {
+
+/*----------------------------------------------------------------------------*/
+/*                               CONSTRUCTORS                                 */
+/*----------------------------------------------------------------------------*/
+
+ThreadPool::ThreadPool(unsigned int number_of_threads) : _next(0) {
+  if (number_of_threads == 0)
+    number_of_threads = std::max(1u, std::thread::hardware_concurrency());
+
+  for (unsigned int worker = 1; worker < number_of_threads; worker++)
+    _threads.emplace_back(&ThreadPool::work, this, worker);
+}
+
+/*----------------------------------------------------------------------------*/
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _stop = true;
+  }
+  _start.notify_all();
+
+  for (auto& thread : _threads) thread.join();
+}
+
+/*----------------------------------------------------------------------------*/
+/*                              STATIC METHODS                                */
+/*----------------------------------------------------------------------------*/
+
+ThreadPoolPtr ThreadPool::make(unsigned int number_of_threads) {
+  return ThreadPoolPtr(new ThreadPool(number_of_threads));
+}
+
+/*----------------------------------------------------------------------------*/
+
+std::vector<std::size_t> ThreadPool::partition(
+    const std::vector<std::size_t>& costs, unsigned int number_of_blocks) {
+  std::size_t total_cost = 0;
+  for (auto cost : costs) total_cost += cost;
+
+  // A block is closed whenever the accumulated cost reaches its share
+  std::vector<std::size_t> limits(1, 0);
+  std::size_t cost = 0;
+  for (std::size_t i = 0; i < costs.size(); i++) {
+    cost += costs[i];
+    if (cost * number_of_blocks >= total_cost * limits.size())
+      limits.push_back(i + 1);
+  }
+  if (limits.back() != costs.size()) limits.push_back(costs.size());
+
+  return limits;
+}
+
+/*----------------------------------------------------------------------------*/
+/*                             CONCRETE METHODS                               */
+/*----------------------------------------------------------------------------*/
+
+void ThreadPool::parallelFor(std::size_t size, const Task& task) {
+  if (size == 0) return;
+
+  if (_threads.empty() || size == 1) {
+    for (std::size_t index = 0; index < size; index++) task(index, 0);
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _task = &task;
+    _size = size;
+    _next = 0;
+    _running = static_cast<unsigned int>(_threads.size());
+    _exception = nullptr;
+    _generation++;
+  }
+  _start.notify_all();
+
+  runTasks(0);
+
+  std::unique_lock<std::mutex> lock(_mutex);
+  _finish.wait(lock, [this] { return _running == 0; });
+  _task = nullptr;
+
+  if (_exception) std::rethrow_exception(_exception);
+}
+
+/*----------------------------------------------------------------------------*/
+
+unsigned int ThreadPool::size() const {
+  return static_cast<unsigned int>(_threads.size()) + 1;
+}
+
+/*----------------------------------------------------------------------------*/
+
+void ThreadPool::work(unsigned int worker) {
+  std::size_t generation = 0;
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(_mutex);
+      _start.wait(lock, [this, generation] {
+        return _stop || _generation != generation;
+      });
+      if (_stop) return;
+      generation = _generation;
+    }
+
+    runTasks(worker);
+
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _running--;
+    }
+    _finish.notify_one();
+  }
+}
+
+/*----------------------------------------------------------------------------*/
+
+void ThreadPool::runTasks(unsigned int worker) {
+  for (auto index = _next++; index < _size; index = _next++) {
+    try {
+      (*_task)(index, worker);
+    } catch (...) {
+      std::lock_guard<std::mutex> lock(_mutex);
+      if (!_exception) _exception = std::current_exception();
+    }
+  }
+}
+
+/*----------------------------------------------------------------------------*/
+
+}  // namespace model
+}  // namespace tops
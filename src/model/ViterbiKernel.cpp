@@ -0,0 +1,210 @@
+/***********************************************************************/
+/*  Copyright 2015 ToPS                                                */
+/*                                                                     */
+/*  This program is free software; you can redistribute it and/or      */
+/*  modify it under the terms of the GNU  General Public License as    */
+/*  published by the Free Software Foundation; either version 3 of     */
+/*  the License, or (at your option) any later version.                */
+/*                                                                     */
+/*  This program is distributed in the hope that it will be useful,    */
+/*  but WITHOUT ANY WARRANTY; without even the implied warranty of     */
+/*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the      */
+/*  GNU General Public License for more details.                       */
+/*                                                                     */
+/*  You should have received a copy of the GNU General Public License  */
+/*  along with this program; if not, write to the Free Software        */
+/*  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,         */
+/*  MA 02110-1301, USA.                                                */
+/***********************************************************************/
+
+// Interface header
+#include "model/ViterbiKernel.hpp"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define TOPS_MODEL_VITERBI_KERNEL_X86
+#endif
+
+// External headers
+#ifdef TOPS_MODEL_VITERBI_KERNEL_X86
+#include <immintrin.h>
+#endif
+
+namespace tops {
+namespace model {
+
+/*----------------------------------------------------------------------------*/
+/*                              LOCAL FUNCTIONS                               */
+/*----------------------------------------------------------------------------*/
+
+namespace {
+
+void scalarStep(unsigned int first,
+                unsigned int n,
+                const double* previous,
+                const double* transitions,
+                const double* emissions,
+                double* current,
+                unsigned int* backpointers) {
+  for (unsigned int k = first; k < n; k++) {
+    double best = previous[0] + transitions[k];
+    unsigned int best_predecessor = 0;
+    for (unsigned int p = 1; p < n; p++) {
+      double v = previous[p] + transitions[p * n + k];
+      if (v > best) {
+        best = v;
+        best_predecessor = p;
+      }
+    }
+    current[k] = best + emissions[k];
+    backpointers[k] = best_predecessor;
+  }
+}
+
+/*----------------------------------------------------------------------------*/
+
+#ifdef TOPS_MODEL_VITERBI_KERNEL_X86
+
+__attribute__((target("sse4.1")))
+void sse4Step(unsigned int n,
+              const double* previous,
+              const double* transitions,
+              const double* emissions,
+              double* current,
+              unsigned int* backpointers) {
+  unsigned int k = 0;
+  for (; k + 2 <= n; k += 2) {
+    __m128d best = _mm_add_pd(_mm_set1_pd(previous[0]),
+                              _mm_loadu_pd(transitions + k));
+    __m128d best_predecessor = _mm_setzero_pd();
+    for (unsigned int p = 1; p < n; p++) {
+      __m128d v = _mm_add_pd(_mm_set1_pd(previous[p]),
+                             _mm_loadu_pd(transitions + p * n + k));
+      __m128d greater = _mm_cmpgt_pd(v, best);
+      best = _mm_max_pd(v, best);
+      best_predecessor = _mm_blendv_pd(
+        best_predecessor, _mm_set1_pd(static_cast<double>(p)), greater);
+    }
+    _mm_storeu_pd(current + k, _mm_add_pd(best, _mm_loadu_pd(emissions + k)));
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(backpointers + k),
+                     _mm_cvtpd_epi32(best_predecessor));
+  }
+  scalarStep(k, n, previous, transitions, emissions, current, backpointers);
+}
+
+/*----------------------------------------------------------------------------*/
+
+__attribute__((target("avx2")))
+void avx2Step(unsigned int n,
+              const double* previous,
+              const double* transitions,
+              const double* emissions,
+              double* current,
+              unsigned int* backpointers) {
+  unsigned int k = 0;
+
+  // Two independent blocks of 4 targets hide the latency of the maximum
+  for (; k + 8 <= n; k += 8) {
+    __m256d source = _mm256_set1_pd(previous[0]);
+    __m256d best0 = _mm256_add_pd(source, _mm256_loadu_pd(transitions + k));
+    __m256d best1 = _mm256_add_pd(source,
+                                  _mm256_loadu_pd(transitions + k + 4));
+    __m256d best_predecessor0 = _mm256_setzero_pd();
+    __m256d best_predecessor1 = _mm256_setzero_pd();
+    for (unsigned int p = 1; p < n; p++) {
+      const double* row = transitions + p * n + k;
+      source = _mm256_set1_pd(previous[p]);
+      __m256d predecessor = _mm256_set1_pd(static_cast<double>(p));
+
+      __m256d v0 = _mm256_add_pd(source, _mm256_loadu_pd(row));
+      __m256d v1 = _mm256_add_pd(source, _mm256_loadu_pd(row + 4));
+      __m256d greater0 = _mm256_cmp_pd(v0, best0, _CMP_GT_OQ);
+      __m256d greater1 = _mm256_cmp_pd(v1, best1, _CMP_GT_OQ);
+      best0 = _mm256_max_pd(v0, best0);
+      best1 = _mm256_max_pd(v1, best1);
+      best_predecessor0
+        = _mm256_blendv_pd(best_predecessor0, predecessor, greater0);
+      best_predecessor1
+        = _mm256_blendv_pd(best_predecessor1, predecessor, greater1);
+    }
+    _mm256_storeu_pd(current + k,
+                     _mm256_add_pd(best0, _mm256_loadu_pd(emissions + k)));
+    _mm256_storeu_pd(current + k + 4,
+                     _mm256_add_pd(best1, _mm256_loadu_pd(emissions + k + 4)));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(backpointers + k),
+                     _mm256_cvtpd_epi32(best_predecessor0));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(backpointers + k + 4),
+                     _mm256_cvtpd_epi32(best_predecessor1));
+  }
+
+  for (; k + 4 <= n; k += 4) {
+    __m256d best = _mm256_add_pd(_mm256_set1_pd(previous[0]),
+                                 _mm256_loadu_pd(transitions + k));
+    __m256d best_predecessor = _mm256_setzero_pd();
+    for (unsigned int p = 1; p < n; p++) {
+      __m256d v = _mm256_add_pd(_mm256_set1_pd(previous[p]),
+                                _mm256_loadu_pd(transitions + p * n + k));
+      __m256d greater = _mm256_cmp_pd(v, best, _CMP_GT_OQ);
+      best = _mm256_max_pd(v, best);
+      best_predecessor = _mm256_blendv_pd(
+        best_predecessor, _mm256_set1_pd(static_cast<double>(p)), greater);
+    }
+    _mm256_storeu_pd(current + k,
+                     _mm256_add_pd(best, _mm256_loadu_pd(emissions + k)));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(backpointers + k),
+                     _mm256_cvtpd_epi32(best_predecessor));
+  }
+
+  scalarStep(k, n, previous, transitions, emissions, current, backpointers);
+}
+
+#endif  // TOPS_MODEL_VITERBI_KERNEL_X86
+
+}  // namespace
+
+/*----------------------------------------------------------------------------*/
+/*                               STATIC METHODS                               */
+/*----------------------------------------------------------------------------*/
+
+ViterbiKernel::extension ViterbiKernel::available() {
+#ifdef TOPS_MODEL_VITERBI_KERNEL_X86
+  static const extension detected = [] {
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return extension::avx2;
+    if (__builtin_cpu_supports("sse4.1")) return extension::sse4;
+    return extension::scalar;
+  }();
+  return detected;
+#else
+  return extension::scalar;
+#endif
+}
+
+/*----------------------------------------------------------------------------*/
+
+void ViterbiKernel::step(extension chosen_extension,
+                         unsigned int n,
+                         const double* previous,
+                         const double* transitions,
+                         const double* emissions,
+                         double* current,
+                         unsigned int* backpointers) {
+  switch (chosen_extension) {
+#ifdef TOPS_MODEL_VITERBI_KERNEL_X86
+    case extension::avx2:
+      avx2Step(n, previous, transitions, emissions, current, backpointers);
+      return;
+    case extension::sse4:
+      sse4Step(n, previous, transitions, emissions, current, backpointers);
+      return;
+#endif
+    default:
+      scalarStep(0, n, previous, transitions, emissions,
+                 current, backpointers);
+      return;
+  }
+}
+
+/*----------------------------------------------------------------------------*/
+
+}  // namespace model
+}  // namespace tops
@@ -0,0 +1,234 @@
+/***********************************************************************/
+/*  Copyright 2015 ToPS                                                */
+/*                                                                     */
+/*  This program is free software; you can redistribute it and/or      */
+/*  modify it under the terms of the GNU  General Public License as    */
+/*  published by the Free Software Foundation; either version 3 of     */
+/*  the License, or (at your option) any later version.                */
+/*                                                                     */
+/*  This program is distributed in the hope that it will be useful,    */
+/*  but WITHOUT ANY WARRANTY; without even the implied warranty of     */
+/*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the      */
+/*  GNU General Public License for more details.                       */
+/*                                                                     */
+/*  You should have received a copy of the GNU General Public License  */
+/*  along with this program; if not, write to the Free Software        */
+/*  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,         */
+/*  MA 02110-1301, USA.                                                */
+/***********************************************************************/
+
+// Standard headers
+#include <vector>
+#include <utility>
+
+// External headers
+#include "gmock/gmock.h"
+
+// ToPS headers
+#include "model/Labeling.hpp"
+#include "model/Sequence.hpp"
+#include "model/Simulator.hpp"
+#include "model/Probability.hpp"
+#include "model/SignalDuration.hpp"
+#include "model/ExplicitDuration.hpp"
+#include "model/GeometricDuration.hpp"
+#include "model/GeneralizedHiddenMarkovModel.hpp"
+
+#include "exception/OutOfRange.hpp"
+
+#include "helper/DiscreteIIDModel.hpp"
+#include "helper/VariableLengthMarkovChain.hpp"
+
+// Tested header
+#include "model/ChunkedViterbi.hpp"
+
+// Macros
+#define DOUBLE(X) static_cast<double>(X)
+
+/*----------------------------------------------------------------------------*/
+/*                             USING DECLARATIONS                             */
+/*----------------------------------------------------------------------------*/
+
+using ::testing::Eq;
+using ::testing::Le;
+using ::testing::Ge;
+using ::testing::Gt;
+using ::testing::Ne;
+using ::testing::IsEmpty;
+using ::testing::DoubleNear;
+using ::testing::ContainerEq;
+
+using tops::model::Labeler;
+using tops::model::Labeling;
+using tops::model::Sequence;
+using tops::model::Simulator;
+using tops::model::Probability;
+using tops::model::ChunkedViterbi;
+using tops::model::SignalDuration;
+using tops::model::DiscreteIIDModel;
+using tops::model::ExplicitDuration;
+using tops::model::GeometricDuration;
+using tops::model::GeneralizedHiddenMarkovModel;
+
+using tops::exception::OutOfRange;
+
+using tops::helper::createVLMCMC;
+using tops::helper::createMachlerVLMC;
+using tops::helper::createFairCoinIIDModel;
+
+/*----------------------------------------------------------------------------*/
+/*                                  FIXTURES                                  */
+/*----------------------------------------------------------------------------*/
+
+class AChunkedViterbi : public testing::Test {
+ protected:
+  using GHMM = GeneralizedHiddenMarkovModel;
+
+  GHMM::StatePtr signal_duration_state
+    = GHMM::State::make(
+      1, createVLMCMC(),
+      DiscreteIIDModel::make(std::vector<Probability>{{ 0.1, 0.0, 0.9 }}),
+      SignalDuration::make(3));
+
+  GHMM::StatePtr explicit_duration_state
+    = GHMM::State::make(
+      2, createFairCoinIIDModel(),
+      DiscreteIIDModel::make(std::vector<Probability>{{ 1.0, 0.0, 0.0 }}),
+      ExplicitDuration::make(
+        DiscreteIIDModel::make(std::vector<Probability>{{
+          0.1, 0.1, 0.1, 0.1, 0.1, 0.1, 0.3, 0.1 }})));
+
+  GHMM::StatePtr geometric_duration_state
+    = GHMM::State::make(
+      0, createMachlerVLMC(),
+      DiscreteIIDModel::make(std::vector<Probability>{{ 0.3, 0.3, 0.4 }}),
+      GeometricDuration::make(0, DiscreteIIDModel::make(
+        std::vector<Probability>{{ 0.3, 0.3, 0.4 }})));
+
+  GHMM::SelfPtr ghmm
+    = GHMM::make(
+      std::vector<GHMM::StatePtr>{
+        geometric_duration_state,
+        signal_duration_state,
+        explicit_duration_state },
+      DiscreteIIDModel::make(std::vector<Probability>{{ 1.0, 0.0, 0.0 }}),
+      3, 2, 8);
+
+  Sequence observation;
+
+  virtual void SetUp() {
+    geometric_duration_state->addSuccessor(0);
+    geometric_duration_state->addSuccessor(1);
+    geometric_duration_state->addSuccessor(2);
+    geometric_duration_state->addPredecessor(0);
+    geometric_duration_state->addPredecessor(1);
+    geometric_duration_state->addPredecessor(2);
+
+    signal_duration_state->addSuccessor(0);
+    signal_duration_state->addSuccessor(2);
+    signal_duration_state->addPredecessor(0);
+
+    explicit_duration_state->addSuccessor(0);
+    explicit_duration_state->addPredecessor(0);
+    explicit_duration_state->addPredecessor(1);
+
+    observation = Simulator::make(ghmm)->simulate(1, 600, 42)[0]
+                    .observation();
+  }
+};
+
+/*----------------------------------------------------------------------------*/
+/*                             TESTS WITH FIXTURE                             */
+/*----------------------------------------------------------------------------*/
+
+TEST_F(AChunkedViterbi, DecodesShortObservationsInASingleChunk) {
+  auto decoder = ChunkedViterbi::make(ghmm, 1000, 50, 2);
+  auto estimation = decoder->labeling(observation);
+
+  auto expected = ghmm->labeler(observation)
+                    ->labeling(Labeler::method::bestPath);
+
+  ASSERT_THAT(decoder->seams(), IsEmpty());
+  ASSERT_THAT(estimation.estimated().label(),
+              ContainerEq(expected.estimated().label()));
+  ASSERT_THAT(DOUBLE(estimation.probability()),
+              DoubleNear(DOUBLE(expected.probability()),
+                         1e-9 * DOUBLE(expected.probability())));
+}
+
+/*----------------------------------------------------------------------------*/
+
+TEST_F(AChunkedViterbi, StitchesTheChunksInsideTheirOverlaps) {
+  auto decoder = ChunkedViterbi::make(ghmm, 100, 40, 4);
+  auto estimation = decoder->labeling(observation);
+  const auto& label = estimation.estimated().label();
+
+  ASSERT_THAT(label.size(), Eq(observation.size()));
+  ASSERT_THAT(decoder->seams().size(), Eq(5u));
+  for (unsigned int c = 0; c < decoder->seams().size(); c++) {
+    auto seam = decoder->seams()[c];
+    ASSERT_THAT(seam.position, Ge(100 * (c + 1) - 40));
+    ASSERT_THAT(seam.position, Le(100 * (c + 1) + 40));
+    ASSERT_THAT(label[seam.position - 1], Ne(label[seam.position]));
+  }
+
+  auto full = ghmm->labeler(observation)
+                ->labeling(Labeler::method::bestPath).estimated().label();
+  ASSERT_THAT(label, ContainerEq(full));
+  ASSERT_THAT(decoder->differences(estimation.estimated()), IsEmpty());
+
+  // Labels that differ from the full decoding are reported as ranges
+  Sequence tampered = label;
+  tampered[250] = tampered[250] == 0 ? 2 : 0;
+  tampered[251] = tampered[250];
+  auto differences = decoder->differences(
+    Labeling<Sequence>(observation, tampered));
+  ASSERT_THAT(differences.size(), Eq(1u));
+  ASSERT_THAT(differences[0].first, Eq(250u));
+  ASSERT_THAT(differences[0].second, Le(252u));
+}
+
+/*----------------------------------------------------------------------------*/
+
+TEST_F(AChunkedViterbi, DecodesAgainTheWindowsWithoutAnAgreedSeam) {
+  // Chunks this short often have no common boundary with their neighbors
+  auto decoder = ChunkedViterbi::make(ghmm, 10, 8, 2);
+  auto estimation = decoder->labeling(observation);
+  const auto& label = estimation.estimated().label();
+
+  ASSERT_THAT(decoder->redecodedWindows(), Ge(1u));
+  ASSERT_THAT(DOUBLE(estimation.probability()), Gt(0.0));
+  for (const auto& seam : decoder->seams())
+    ASSERT_THAT(label[seam.position - 1], Ne(label[seam.position]));
+}
+
+/*----------------------------------------------------------------------------*/
+
+TEST_F(AChunkedViterbi, RejectsOverlapsShorterThanTheLongestSegment) {
+  ASSERT_THROW(ChunkedViterbi::make(ghmm, 100, 7), OutOfRange);
+  ASSERT_NO_THROW(ChunkedViterbi::make(ghmm, 100, 8));
+
+  // Explicit durations are as long as the backtracking limit
+  auto uncapped = GHMM::make(
+    std::vector<GHMM::StatePtr>{
+      geometric_duration_state,
+      signal_duration_state,
+      explicit_duration_state },
+    DiscreteIIDModel::make(std::vector<Probability>{{ 1.0, 0.0, 0.0 }}),
+    3, 2);
+  ASSERT_THROW(ChunkedViterbi::make(uncapped, 100, 50), OutOfRange);
+}
+
+/*----------------------------------------------------------------------------*/
+
+TEST_F(AChunkedViterbi, FindsTheSameLabelsWithAnyNumberOfThreads) {
+  auto sequential = ChunkedViterbi::make(ghmm, 70, 30, 1)
+                      ->labeling(observation);
+  auto parallel = ChunkedViterbi::make(ghmm, 70, 30, 4)
+                    ->labeling(observation);
+
+  ASSERT_THAT(parallel.estimated().label(),
+              ContainerEq(sequential.estimated().label()));
+}
+
+/*----------------------------------------------------------------------------*/
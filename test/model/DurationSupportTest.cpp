@@ -0,0 +1,81 @@
+/***********************************************************************/
+/*  Copyright 2015 ToPS                                                */
+/*                                                                     */
+/*  This program is free software; you can redistribute it and/or      */
+/*  modify it under the terms of the GNU  General Public License as    */
+/*  published by the Free Software Foundation; either version 3 of     */
+/*  the License, or (at your option) any later version.                */
+/*                                                                     */
+/*  This program is distributed in the hope that it will be useful,    */
+/*  but WITHOUT ANY WARRANTY; without even the implied warranty of     */
+/*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the      */
+/*  GNU General Public License for more details.                       */
+/*                                                                     */
+/*  You should have received a copy of the GNU General Public License  */
+/*  along with this program; if not, write to the Free Software        */
+/*  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,         */
+/*  MA 02110-1301, USA.                                                */
+/***********************************************************************/
+
+// Standard headers
+#include <vector>
+
+// External headers
+#include "gmock/gmock.h"
+
+// Tested header
+#include "model/DurationSupport.hpp"
+
+/*----------------------------------------------------------------------------*/
+/*                             USING DECLARATIONS                             */
+/*----------------------------------------------------------------------------*/
+
+using ::testing::Eq;
+using ::testing::ContainerEq;
+
+using tops::model::DurationSupport;
+
+/*----------------------------------------------------------------------------*/
+/*                                SIMPLE TESTS                                */
+/*----------------------------------------------------------------------------*/
+
+TEST(ADurationSupport, ShouldIterateOverAnArithmeticProgression) {
+  DurationSupport support(3, 12, 3);
+
+  ASSERT_THAT(std::vector<unsigned int>(support.begin(), support.end()),
+              ContainerEq(std::vector<unsigned int>{ 3, 6, 9, 12 }));
+  ASSERT_THAT(support.size(), Eq(4u));
+  ASSERT_THAT(support.last(), Eq(12u));
+}
+
+/*----------------------------------------------------------------------------*/
+
+TEST(ADurationSupport, ShouldBeRestrictedToLengthsUpToALimit) {
+  DurationSupport support(3, 12, 3);
+
+  auto restricted = support.upTo(10);
+  ASSERT_THAT(std::vector<unsigned int>(restricted.begin(), restricted.end()),
+              ContainerEq(std::vector<unsigned int>{ 3, 6, 9 }));
+  ASSERT_THAT(support.upTo(100).size(), Eq(4u));
+  ASSERT_THAT(support.upTo(2).empty(), Eq(true));
+  ASSERT_THAT(DurationSupport(5, 4).empty(), Eq(true));
+}
+
+/*----------------------------------------------------------------------------*/
+
+TEST(ADurationSupport, ShouldIterateOverASortedListOfLengths) {
+  std::vector<unsigned int> lengths { 2, 5, 8, 11 };
+  DurationSupport support(lengths);
+
+  ASSERT_THAT(std::vector<unsigned int>(support.begin(), support.end()),
+              ContainerEq(lengths));
+  ASSERT_THAT(support.first(), Eq(2u));
+  ASSERT_THAT(support.last(), Eq(11u));
+
+  auto restricted = support.upTo(8);
+  ASSERT_THAT(std::vector<unsigned int>(restricted.begin(), restricted.end()),
+              ContainerEq(std::vector<unsigned int>{ 2, 5, 8 }));
+  ASSERT_THAT(support.upTo(1).empty(), Eq(true));
+}
+
+/*----------------------------------------------------------------------------*/
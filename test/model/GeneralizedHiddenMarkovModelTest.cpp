@@ -18,9 +18,14 @@
 /***********************************************************************/
 
 // Standard headers
+#include <map>
+#include <set>
 #include <cmath>
 #include <limits>
+#include <functional>
+#include <random>
 #include <vector>
+#include <algorithm>
 
 // External headers
 #include "gmock/gmock.h"
@@ -28,7 +33,9 @@
 // ToPS headers
 #include "model/Util.hpp"
 #include "model/Matrix.hpp"
+#include "model/Segment.hpp"
 #include "model/Sequence.hpp"
+#include "model/Simulator.hpp"
 #include "model/Probability.hpp"
 #include "model/SignalDuration.hpp"
 #include "model/ExplicitDuration.hpp"
@@ -52,16 +59,27 @@
 /*----------------------------------------------------------------------------*/
 
 using ::testing::Eq;
+using ::testing::Ge;
+using ::testing::Gt;
+using ::testing::Le;
+using ::testing::Lt;
 using ::testing::DoubleEq;
 using ::testing::DoubleNear;
 using ::testing::ContainerEq;
 
+using tops::model::Beam;
+using tops::model::NBest;
 using tops::model::Matrix;
 using tops::model::Labeler;
 using tops::model::log_sum;
 using tops::model::Labeling;
+using tops::model::Segment;
 using tops::model::Sequence;
+using tops::model::Simulator;
+using tops::model::RNGAdapter;
+using tops::model::Consensus;
 using tops::model::Calculator;
+using tops::model::Posteriors;
 using tops::model::Probability;
 using tops::model::SignalDuration;
 using tops::model::DiscreteIIDModel;
@@ -143,6 +161,49 @@ class AGHMM : public testing::Test {
   }
 };
 
+/*----------------------------------------------------------------------------*/
+
+class ASelfLoopingGHMM : public testing::Test {
+ protected:
+  // Both states may follow themselves, so a run of labels may be split
+  // into segments in several ways
+  std::vector<std::vector<double>> durations {
+    { 0.0, 0.5, 0.3, 0.2 }, { 0.0, 0.6, 0.4 } };
+  std::vector<std::vector<double>> emissions {
+    { 0.9, 0.1 }, { 0.2, 0.8 } };
+  std::vector<std::vector<double>> transitions {
+    { 0.4, 0.6 }, { 0.5, 0.5 } };
+  std::vector<double> initial { 0.5, 0.5 };
+
+  GeneralizedHiddenMarkovModelPtr model;
+
+  virtual void SetUp() {
+    std::vector<GHMM::StatePtr> states;
+    for (unsigned int k = 0; k < 2; k++) {
+      states.push_back(GHMM::State::make(
+        k,
+        DiscreteIIDModel::make(std::vector<Probability>(
+          emissions[k].begin(), emissions[k].end())),
+        DiscreteIIDModel::make(std::vector<Probability>(
+          transitions[k].begin(), transitions[k].end())),
+        ExplicitDuration::make(DiscreteIIDModel::make(
+          std::vector<Probability>(
+            durations[k].begin(), durations[k].end())))));
+    }
+    for (auto& state : states) {
+      for (unsigned int k = 0; k < 2; k++) {
+        state->addPredecessor(k);
+        state->addSuccessor(k);
+      }
+    }
+    model = GeneralizedHiddenMarkovModel::make(
+      states,
+      DiscreteIIDModel::make(std::vector<Probability>(
+        initial.begin(), initial.end())),
+      2, 2);
+  }
+};
+
 /*----------------------------------------------------------------------------*/
 /*                             TESTS WITH FIXTURE                             */
 /*----------------------------------------------------------------------------*/
@@ -249,6 +310,310 @@ TEST_F(AGHMM, ShouldFindBestPathUsingViterbiDecodingWithCache) {
 
 /*----------------------------------------------------------------------------*/
 
+TEST_F(AGHMM, ShouldLabelABatchOfSequencesInInputOrder) {
+  std::vector<Sequence> observations {
+    { 0, 0, 0, 1, 0 },
+    { 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0 },
+    { 1, 0, 1, 0, 0, 0, 0, 1, 1 },
+  };
+
+  auto estimations = ghmm->label(observations, Labeler::method::bestPath, 2);
+
+  ASSERT_THAT(estimations.size(), Eq(observations.size()));
+  for (std::size_t i = 0; i < observations.size(); i++) {
+    auto expected = ghmm->labeler(observations[i], true)
+                        ->labeling(Labeler::method::bestPath);
+
+    ASSERT_THAT(estimations[i].estimated().label(),
+                ContainerEq(expected.estimated().label()));
+    ASSERT_THAT(DOUBLE(estimations[i].probability()),
+                DoubleEq(DOUBLE(expected.probability())));
+  }
+}
+
+/*----------------------------------------------------------------------------*/
+
+TEST_F(AGHMM, ShouldFindTheNMostProbableLabelings) {
+  Sequence observation {
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0 };
+
+  auto labeler = ghmm->labeler(observation, true);
+  auto expected = labeler->labeling(Labeler::method::bestPath);
+
+  NBest nbest;
+  nbest.size = 10;
+  auto estimation = labeler->labeling(nbest);
+
+  ASSERT_THAT(nbest.labelings.size(), Eq(10u));
+  ASSERT_THAT(estimation.estimated().label(),
+              ContainerEq(expected.estimated().label()));
+  ASSERT_THAT(DOUBLE(estimation.probability()),
+              DoubleNear(DOUBLE(expected.probability()),
+                         1e-9 * DOUBLE(expected.probability())));
+
+  std::set<Sequence> labels;
+  for (unsigned int r = 0; r < nbest.labelings.size(); r++) {
+    labels.insert(nbest.labelings[r].estimated().label());
+    if (r > 0) {
+      ASSERT_THAT(DOUBLE(nbest.labelings[r].probability()),
+                  Le(DOUBLE(nbest.labelings[r-1].probability())));
+    }
+  }
+  ASSERT_THAT(labels.size(), Eq(10u));
+
+  // No labeling left out is more probable than the ones found
+  auto worst = DOUBLE(nbest.labelings.back().probability());
+  for (const auto& sample : labeler->sampling(
+         2000, RNGAdapter<std::mt19937>::make(42))) {
+    if (labels.count(sample.estimated().label()) == 0) {
+      ASSERT_THAT(DOUBLE(sample.probability()), Le(worst * (1 + 1e-9)));
+    }
+  }
+}
+
+/*----------------------------------------------------------------------------*/
+
+TEST_F(AGHMM, ShouldThrowAnNotYetImplementedForLazyNBestLabelings) {
+  Sequence observation { 0, 0, 0, 1, 0, 1, 0 };
+
+  NBest nbest;
+  nbest.size = 3;
+  nbest.lazy = true;
+  ASSERT_THROW(ghmm->labeler(observation)->labeling(nbest),
+               NotYetImplemented);
+}
+
+/*----------------------------------------------------------------------------*/
+
+TEST_F(ASelfLoopingGHMM, ShouldFindTheNMostProbableDistinctLabelings) {
+  Sequence observation { 0, 1, 1, 0, 0, 1 };
+  unsigned int length = observation.size();
+
+  // Probability of the best segmentation of each labeling
+  std::function<double(const Sequence&, unsigned int, int)> best
+    = [&](const Sequence& label, unsigned int begin, int previous) {
+    if (begin == length) return 1.0;
+    unsigned int k = label[begin];
+    double max = 0.0, emission = 1.0;
+    for (unsigned int d = 1; begin + d <= length
+                             && label[begin + d - 1] == k
+                             && d < durations[k].size(); d++) {
+      emission *= emissions[k][observation[begin + d - 1]];
+      double score = (previous < 0 ? initial[k] : transitions[previous][k])
+        * durations[k][d] * emission * best(label, begin + d, k);
+      max = std::max(max, score);
+    }
+    return max;
+  };
+
+  std::vector<double> expected;
+  for (const auto& label : generateAllCombinationsOfSymbols(length))
+    expected.push_back(best(label, 0, -1));
+  std::sort(expected.begin(), expected.end(), std::greater<double>());
+
+  NBest nbest;
+  nbest.size = 10;
+  model->labeler(observation)->labeling(nbest);
+
+  ASSERT_THAT(nbest.labelings.size(), Eq(10u));
+
+  std::set<Sequence> labels;
+  for (unsigned int r = 0; r < nbest.labelings.size(); r++) {
+    const auto& labeling = nbest.labelings[r];
+    labels.insert(labeling.estimated().label());
+    ASSERT_THAT(DOUBLE(labeling.probability()),
+                DoubleNear(expected[r], 1e-9 * expected[r]));
+    ASSERT_THAT(best(labeling.estimated().label(), 0, -1),
+                DoubleNear(expected[r], 1e-9 * expected[r]));
+  }
+  ASSERT_THAT(labels.size(), Eq(10u));
+}
+
+/*----------------------------------------------------------------------------*/
+
+TEST_F(AGHMM, ShouldFindBestPathUsingBeamSearch) {
+  Sequence observation {
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0 };
+  Sequence label {
+    0, 2, 2, 2, 2, 2, 2, 2, 0, 1, 1, 1, 2, 2, 2, 2, 2, 0, 1, 1, 1 };
+
+  auto labeler = ghmm->labeler(observation);
+  auto expected = labeler->labeling(Labeler::method::bestPath);
+
+  Beam beam;
+  beam.margin = 20;
+  auto estimation = labeler->labeling(beam);
+
+  ASSERT_THAT(estimation.estimated().label(), ContainerEq(label));
+  ASSERT_THAT(DOUBLE(estimation.probability()),
+              DoubleEq(DOUBLE(expected.probability())));
+
+  // Unreachable cells are not counted: the signal (3 symbols, never
+  // initial) cannot end at positions 0 to 2, nor the explicit state at 0
+  ASSERT_THAT(beam.cells, Eq(3 * observation.size() - 4));
+  ASSERT_THAT(beam.pruned_cells, Eq(0u));
+}
+
+/*----------------------------------------------------------------------------*/
+
+TEST_F(AGHMM, ShouldPruneAllButTheBestStateWithABeamOfWidthOne) {
+  Sequence observation {
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0 };
+
+  Beam beam;
+  beam.width = 1;
+  ghmm->labeler(observation, true)->labeling(beam);
+
+  ASSERT_THAT(beam.pruned_cells, Eq(beam.cells - observation.size()));
+  ASSERT_THAT(beam.pruningRate(),
+              DoubleEq(static_cast<double>(beam.pruned_cells) / beam.cells));
+}
+
+/*----------------------------------------------------------------------------*/
+
+TEST_F(AGHMM, ShouldBoundTheScoreLostByABeam) {
+  Sequence observation {
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0 };
+
+  auto labeler = ghmm->labeler(observation, true);
+  auto expected = labeler->labeling(Labeler::method::bestPath);
+
+  Beam beam;
+  beam.width = 1;
+  beam.bounded = true;
+  auto estimation = labeler->labeling(beam);
+
+  ASSERT_THAT(beam.pruned_cells, Gt(0u));
+  ASSERT_THAT(beam.score_loss_bound, Ge(0.0));
+  ASSERT_THAT(beam.score_loss_bound, Lt(1e3));
+  ASSERT_THAT(
+    std::log(DOUBLE(expected.probability() / estimation.probability())),
+    Le(beam.score_loss_bound + 1e-9));
+
+  Beam unbounded;
+  unbounded.bounded = true;
+  labeler->labeling(unbounded);
+  ASSERT_THAT(unbounded.score_loss_bound, DoubleEq(0.0));
+}
+
+/*----------------------------------------------------------------------------*/
+
+TEST_F(AGHMM, ShouldBeTrainedUsingViterbiTraining) {
+  Sequence observation {
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0 };
+
+  auto ghmm_trainer = GHMM::standardTrainer();
+  ghmm_trainer->add_training_sequence(observation);
+
+  // Best path: 0 | 2 2 2 2 2 2 2 | 0 | 1 1 1 | 2 2 2 2 2 | 0 | 1 1 1
+  auto trained_ghmm = ghmm_trainer->train(
+    GHMM::viterbi_training_algorithm{}, ghmm, 1, 0.0, 2);
+
+  auto trained_transition = trained_ghmm->state(0)->transition();
+  ASSERT_THAT(DOUBLE(trained_transition->probabilityOf(1)),
+              DoubleNear(2.0 / 3.0, 1e-9));
+  ASSERT_THAT(DOUBLE(trained_transition->probabilityOf(2)),
+              DoubleNear(1.0 / 3.0, 1e-9));
+
+  auto explicit_duration = trained_ghmm->state(2)->duration();
+  ASSERT_THAT(DOUBLE(explicit_duration->probabilityOfLenght(5)),
+              DoubleNear(0.5, 1e-9));
+  ASSERT_THAT(DOUBLE(explicit_duration->probabilityOfLenght(7)),
+              DoubleNear(0.5, 1e-9));
+
+  auto expected = ghmm->labeler(observation)
+                      ->labeling(Labeler::method::bestPath);
+  auto estimation = trained_ghmm->labeler(observation)
+                                ->labeling(Labeler::method::bestPath);
+  ASSERT_THAT(DOUBLE(estimation.probability()),
+              Ge(DOUBLE(expected.probability())));
+}
+
+/*----------------------------------------------------------------------------*/
+
+TEST_F(ASelfLoopingGHMM, ShouldCountSegmentsOfAStateThatFollowsItself) {
+  Sequence observation { 0, 0, 0, 0, 0, 0 };
+
+  auto trainer = GHMM::standardTrainer();
+  trainer->add_training_sequence(observation);
+
+  // Best path: 0 0 0 | 0 0 0, a single run of labels
+  auto trained = trainer->train(
+    GHMM::viterbi_training_algorithm{}, model, 1, 0.0, 1);
+
+  ASSERT_THAT(DOUBLE(trained->state(0)->transition()->probabilityOf(0)),
+              DoubleNear(1.0, 1e-9));
+  ASSERT_THAT(DOUBLE(trained->state(0)->duration()->probabilityOfLenght(3)),
+              DoubleNear(1.0, 1e-9));
+}
+
+/*----------------------------------------------------------------------------*/
+
+TEST_F(AGHMM, ShouldFindTheSameLabelsUsingFusedPosteriors) {
+  Sequence observation {
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0 };
+  Sequence label {
+    0, 0, 0, 0, 0, 2, 2, 2, 0, 0, 0, 0, 2, 0, 1, 0, 2, 0, 2, 0, 1 };
+
+  Matrix probabilities;
+  ghmm->posteriorProbabilities(observation, probabilities);
+
+  Posteriors posteriors;
+  posteriors.states = { 2 };
+  auto estimation = ghmm->labeler(observation, true)->labeling(posteriors);
+
+  ASSERT_THAT(estimation.estimated().label(), ContainerEq(label));
+  for (unsigned int i = 0; i < observation.size(); i++) {
+    ASSERT_THAT(DOUBLE(posteriors.max_posteriors[i]),
+                DoubleNear(DOUBLE(probabilities(label[i], i)), 1e-12));
+    ASSERT_THAT(DOUBLE(posteriors.probabilities(0, i)),
+                DoubleNear(DOUBLE(probabilities(2, i)), 1e-12));
+  }
+}
+
+/*----------------------------------------------------------------------------*/
+
+TEST_F(ASelfLoopingGHMM, ShouldScoreTheLabelsFoundUsingFusedPosteriors) {
+  Sequence observation { 0, 1, 1, 0, 0, 1, 0, 0, 0, 1 };
+
+  Posteriors posteriors;
+  auto estimation = model->labeler(observation)->labeling(posteriors);
+
+  auto expected = model->labelingEvaluator(estimation.estimated())
+                    ->evaluateSequence(0, observation.size());
+  ASSERT_THAT(DOUBLE(estimation.probability()), Gt(0.0));
+  ASSERT_THAT(DOUBLE(estimation.probability()),
+              DoubleNear(DOUBLE(expected), 1e-9 * DOUBLE(expected)));
+}
+
+/*----------------------------------------------------------------------------*/
+
+TEST_F(AGHMM, ShouldSampleLabelingsFromTheirPosteriorDistribution) {
+  Sequence observation { 0, 0, 0, 1, 0, 1, 0 };
+  auto px = ghmm->calculator(observation)
+              ->calculate(Calculator::direction::forward);
+
+  auto labeler = ghmm->labeler(observation, true);
+  auto samples = labeler->sampling(20000, RNGAdapter<std::mt19937>::make(42));
+
+  std::map<Sequence, unsigned int> frequencies;
+  for (const auto& sample : samples)
+    frequencies[sample.estimated().label()]++;
+
+  for (const auto& sample : samples) {
+    auto label = sample.estimated().label();
+    ASSERT_THAT(frequencies[label] / 20000.0,
+                DoubleNear(DOUBLE(sample.probability() / px), 0.015));
+  }
+
+  auto again = labeler->sampling(100, RNGAdapter<std::mt19937>::make(42), 1);
+  for (unsigned int s = 0; s < again.size(); s++)
+    ASSERT_THAT(again[s].estimated().label(),
+                ContainerEq(samples[s].estimated().label()));
+}
+
+/*----------------------------------------------------------------------------*/
+
 TEST_F(AGHMM, ShouldFindBestPathUsingPosteriorDecodingWithoutCache) {
   Sequence observation {
     0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0 };
@@ -311,3 +676,219 @@ TEST_F(AGHMM,
 }
 
 /*----------------------------------------------------------------------------*/
+
+TEST_F(AGHMM, ShouldBeSimulatedSegmentBySegment) {
+  auto labelings = Simulator::make(ghmm)->simulate(100, 80, 42);
+
+  for (const auto& labeling : labelings) {
+    ASSERT_THAT(labeling.observation().size(), Eq(80u));
+    ASSERT_THAT(labeling.label().size(), Eq(80u));
+    ASSERT_THAT(labeling.label()[0], Eq(0u));
+    for (auto symbol : labeling.observation()) ASSERT_THAT(symbol, Le(1u));
+
+    auto segments = Segment::readSequence(labeling.label());
+    for (unsigned int i = 0; i < segments.size(); i++) {
+      auto length = segments[i].end() - segments[i].begin();
+      if (segments[i].symbol() == 1) {
+        if (i + 1 < segments.size()) {
+          ASSERT_THAT(length, Eq(3));
+        }
+        if (i > 0) {
+          ASSERT_THAT(segments[i-1].symbol(), Eq(0u));
+        }
+      }
+      if (segments[i].symbol() == 2 && i + 1 < segments.size()) {
+        ASSERT_THAT(segments[i+1].symbol(), Eq(0u));
+      }
+    }
+  }
+}
+
+/*----------------------------------------------------------------------------*/
+
+TEST_F(AGHMM, ShouldNotBacktrackFurtherThanItsLimit) {
+  Sequence sequence {
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0 };
+
+  auto capped = GeneralizedHiddenMarkovModel::make(
+    std::vector<GHMM::StatePtr>{
+      geometric_duration_state,
+      signal_duration_state,
+      explicit_duration_state },
+    DiscreteIIDModel::make(std::vector<Probability>{{ 1.0, 0.0, 0.0 }}),
+    3, 2, 2);
+
+  ASSERT_THAT(capped->maxDuration(0), Eq(1u));
+  ASSERT_THAT(capped->maxDuration(1), Eq(3u));
+  ASSERT_THAT(capped->maxDuration(2), Eq(2u));
+
+  auto calculator = capped->calculator(sequence);
+  auto forward = DOUBLE(calculator->calculate(Calculator::direction::forward));
+  ASSERT_THAT(
+    DOUBLE(calculator->calculate(Calculator::direction::backward)),
+    DoubleNear(forward, 1e-9 * forward));
+  ASSERT_THAT(forward, Lt(DOUBLE(ghmm->calculator(sequence)
+                          ->calculate(Calculator::direction::forward))));
+
+  auto labeler = capped->labeler(sequence, true);
+  auto labels = labeler->labeling(Labeler::method::bestPath)
+                  .estimated().label();
+  for (const auto& sample : labeler->sampling(
+         200, RNGAdapter<std::mt19937>::make(42))) {
+    for (auto segment : Segment::readSequence(sample.estimated().label())) {
+      if (segment.symbol() == 2) {
+        ASSERT_THAT(segment.end() - segment.begin(), Le(2));
+      }
+    }
+  }
+  for (auto segment : capped->saturatedSegments(labels))
+    ASSERT_THAT(segment.symbol(), Eq(2u));
+}
+
+/*----------------------------------------------------------------------------*/
+
+TEST_F(AGHMM, ShouldReportSegmentsCutByTheBacktrackingLimit) {
+  auto capped = GeneralizedHiddenMarkovModel::make(
+    std::vector<GHMM::StatePtr>{
+      geometric_duration_state,
+      signal_duration_state,
+      explicit_duration_state },
+    DiscreteIIDModel::make(std::vector<Probability>{{ 1.0, 0.0, 0.0 }}),
+    3, 2, 4);
+
+  auto saturated = capped->saturatedSegments(
+    Sequence{ 0, 2, 2, 2, 2, 0, 0, 0, 0, 0, 2, 2, 0, 1, 1, 1, 0 });
+
+  ASSERT_THAT(saturated.size(), Eq(1u));
+  ASSERT_THAT(saturated[0].begin(), Eq(1));
+  ASSERT_THAT(saturated[0].end(), Eq(5));
+}
+
+/*----------------------------------------------------------------------------*/
+
+TEST_F(AGHMM, ShouldTabulateTheProbabilitiesOfItsDurations) {
+  auto explicit_duration = explicit_duration_state->duration();
+  ASSERT_THAT(DOUBLE(explicit_duration->probabilityOfLenght(6)),
+              DoubleNear(0.3, 1e-9));
+  ASSERT_THAT(DOUBLE(explicit_duration->survival(0)), DoubleNear(1.0, 1e-9));
+  ASSERT_THAT(DOUBLE(explicit_duration->survival(6)), DoubleNear(0.4, 1e-9));
+  ASSERT_THAT(DOUBLE(explicit_duration->survival(8)), DoubleEq(0.0));
+  ASSERT_THAT(DOUBLE(explicit_duration->survival(1000)), DoubleEq(0.0));
+
+  auto support = explicit_duration->support();
+  ASSERT_THAT(std::vector<unsigned int>(support.begin(), support.end()),
+              ContainerEq(std::vector<unsigned int>{ 1, 2, 3, 4, 5, 6, 7 }));
+
+  auto sparse_duration = ExplicitDuration::make(
+    DiscreteIIDModel::make(std::vector<Probability>{{
+      0.0, 0.0, 0.0, 0.5, 0.0, 0.0, 0.5 }}));
+  support = sparse_duration->support();
+  ASSERT_THAT(std::vector<unsigned int>(support.begin(), support.end()),
+              ContainerEq(std::vector<unsigned int>{ 3, 6 }));
+
+  auto signal_duration = signal_duration_state->duration();
+  ASSERT_THAT(DOUBLE(signal_duration->survival(3)), DoubleEq(1.0));
+  ASSERT_THAT(DOUBLE(signal_duration->survival(4)), DoubleEq(0.0));
+
+  auto geometric_duration = geometric_duration_state->duration();
+  ASSERT_THAT(DOUBLE(geometric_duration->probabilityOfLenght(3)),
+              DoubleNear(0.09, 1e-9));
+  ASSERT_THAT(DOUBLE(geometric_duration->survival(3)),
+              DoubleNear(0.09, 1e-9));
+}
+
+/*----------------------------------------------------------------------------*/
+
+TEST_F(AGHMM, ShouldComputeTheSameColumnsInParallel) {
+  Sequence observation {
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0 };
+
+  auto parallel = GeneralizedHiddenMarkovModel::make(*ghmm);
+  parallel->parallelizeColumns(3);
+
+  auto expected = ghmm->labeler(observation)
+                    ->labeling(Labeler::method::bestPath);
+  auto estimation = parallel->labeler(observation)
+                      ->labeling(Labeler::method::bestPath);
+  ASSERT_THAT(estimation.estimated().label(),
+              ContainerEq(expected.estimated().label()));
+  ASSERT_THAT(DOUBLE(estimation.probability()),
+              DoubleEq(DOUBLE(expected.probability())));
+
+  Beam beam;
+  beam.margin = 20;
+  ASSERT_THAT(parallel->labeler(observation)->labeling(beam)
+                .estimated().label(),
+              ContainerEq(expected.estimated().label()));
+
+  ASSERT_THAT(
+    DOUBLE(parallel->calculator(observation, true)
+             ->calculate(Calculator::direction::forward)),
+    DoubleEq(DOUBLE(ghmm->calculator(observation, true)
+                      ->calculate(Calculator::direction::forward))));
+}
+
+/*----------------------------------------------------------------------------*/
+
+TEST_F(AGHMM, ShouldOnlyStartConstrainedSegmentsAtTheirConsensus) {
+  Sequence observation {
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0 };
+
+  auto constrained_model = [&] (Sequence symbols, unsigned int offset) {
+    auto constrained_state = GHMM::State::make(
+      1, createVLMCMC(),
+      DiscreteIIDModel::make(std::vector<Probability>{{ 0.1, 0.0, 0.9 }}),
+      SignalDuration::make(3),
+      std::vector<Consensus>{ Consensus(symbols) }, offset);
+    constrained_state->addSuccessor(0);
+    constrained_state->addSuccessor(2);
+    constrained_state->addPredecessor(0);
+
+    return GeneralizedHiddenMarkovModel::make(
+      std::vector<GHMM::StatePtr>{
+        geometric_duration_state,
+        constrained_state,
+        explicit_duration_state },
+      DiscreteIIDModel::make(std::vector<Probability>{{ 1.0, 0.0, 0.0 }}),
+      3, 2);
+  };
+
+  // A consensus matching every symbol keeps the model as it is
+  auto unconstrained = constrained_model({ 0, 1 }, 0);
+  auto expected = ghmm->labeler(observation)
+                    ->labeling(Labeler::method::bestPath);
+  auto estimation = unconstrained->labeler(observation)
+                      ->labeling(Labeler::method::bestPath);
+  ASSERT_THAT(estimation.estimated().label(),
+              ContainerEq(expected.estimated().label()));
+  ASSERT_THAT(DOUBLE(estimation.probability()),
+              DoubleEq(DOUBLE(expected.probability())));
+
+  auto constrained = constrained_model({ 1 }, 1);
+  auto calculator = constrained->calculator(observation);
+  auto forward = DOUBLE(calculator->calculate(Calculator::direction::forward));
+  ASSERT_THAT(
+    DOUBLE(calculator->calculate(Calculator::direction::backward)),
+    DoubleNear(forward, 1e-9 * forward));
+  ASSERT_THAT(forward, Lt(DOUBLE(ghmm->calculator(observation)
+                          ->calculate(Calculator::direction::forward))));
+
+  auto labeler = constrained->labeler(observation, true);
+  auto labels = labeler->labeling(Labeler::method::bestPath)
+                  .estimated().label();
+  for (auto segment : Segment::readSequence(labels)) {
+    if (segment.symbol() == 1) {
+      ASSERT_THAT(observation[segment.begin() + 1], Eq(1u));
+    }
+  }
+  for (const auto& sample : labeler->sampling(
+         200, RNGAdapter<std::mt19937>::make(42))) {
+    for (auto segment : Segment::readSequence(sample.estimated().label())) {
+      if (segment.symbol() == 1) {
+        ASSERT_THAT(observation[segment.begin() + 1], Eq(1u));
+      }
+    }
+  }
+}
+
+/*----------------------------------------------------------------------------*/
@@ -18,9 +18,14 @@
 /***********************************************************************/
 
 // Standard headers
+#include <map>
+#include <set>
 #include <cmath>
 #include <limits>
+#include <random>
+#include <thread>
 #include <vector>
+#include <algorithm>
 
 // External headers
 #include "gmock/gmock.h"
@@ -30,6 +35,7 @@
 #include "model/Sequence.hpp"
 #include "model/Probability.hpp"
 
+#include "exception/OutOfRange.hpp"
 #include "exception/NotYetImplemented.hpp"
 
 #include "helper/Sequence.hpp"
@@ -47,24 +53,35 @@
 /*----------------------------------------------------------------------------*/
 
 using ::testing::Eq;
+using ::testing::Ge;
+using ::testing::Le;
 using ::testing::DoubleEq;
 using ::testing::DoubleNear;
 using ::testing::ContainerEq;
 
+using tops::model::Beam;
+using tops::model::NBest;
 using tops::model::Matrix;
 using tops::model::log_sum;
 using tops::model::Labeler;
 using tops::model::Labeling;
 using tops::model::Sequence;
+using tops::model::RNGAdapter;
 using tops::model::Calculator;
+using tops::model::Posteriors;
 using tops::model::Probability;
+using tops::model::DiscreteIIDModel;
 using tops::model::INVALID_SYMBOL;
 using tops::model::HiddenMarkovModel;
 using tops::model::HiddenMarkovModelPtr;
 
+using tops::exception::OutOfRange;
 using tops::exception::NotYetImplemented;
 
 using tops::helper::SExprTranslator;
+using tops::helper::generateRandomHMM;
+using tops::helper::generateRandomSequence;
+using tops::helper::createCircularHMM;
 using tops::helper::createDishonestCoinCasinoHMM;
 using tops::helper::generateAllCombinationsOfSymbols;
 
@@ -175,6 +192,344 @@ TEST_F(AHiddenMarkovModel, FindsTheBestPathWithCache) {
 
 /*----------------------------------------------------------------------------*/
 
+TEST_F(AHiddenMarkovModel, FindsTheBestPathWithVectorizedKernel) {
+  std::vector<std::vector<Sequence>> test_set = {
+    {{0}, {0}},
+    {{1}, {0}},
+    {{0, 0, 0}, {0, 0, 0}},
+    {{1, 1, 1, 1, 1, 1}, {0, 1, 1, 1, 1, 1}}
+  };
+  for (auto test : test_set) {
+    auto labeler = hmm->labeler(test[0]);
+    auto estimation = labeler->labeling(Labeler::method::vectorizedBestPath);
+    auto labeling = estimation.estimated();
+
+    ASSERT_THAT(labeling.label(), Eq(test[1]));
+  }
+}
+
+/*----------------------------------------------------------------------------*/
+
+TEST(HiddenMarkovModel, FindsTheSameBestPathWithVectorizedKernel) {
+  auto hmm = generateRandomHMM(37, 4);
+  auto sequence = generateRandomSequence(50, 4);
+
+  auto labeler = hmm->labeler(sequence);
+  auto expected = labeler->labeling(Labeler::method::bestPath);
+  auto estimation = labeler->labeling(Labeler::method::vectorizedBestPath);
+
+  ASSERT_THAT(estimation.estimated().label(),
+              Eq(expected.estimated().label()));
+  ASSERT_THAT(DOUBLE(estimation.probability() / expected.probability()),
+              DoubleNear(1.0, 1e-9));
+}
+
+/*----------------------------------------------------------------------------*/
+
+TEST(HiddenMarkovModel, FindsTheSameLabelsWithCheckpoints) {
+  auto hmm = generateRandomHMM(13, 4);
+
+  for (unsigned int size : { 1, 2, 3, 16, 97 }) {
+    auto sequence = generateRandomSequence(size, 4);
+
+    auto labeler = hmm->labeler(sequence);
+    auto checkpointed_labeler
+      = hmm->labeler(sequence, true, Labeler::memory::checkpointed);
+
+    for (auto method : { Labeler::method::bestPath,
+                         Labeler::method::posteriorDecoding }) {
+      auto expected = labeler->labeling(method);
+      auto estimation = checkpointed_labeler->labeling(method);
+
+      ASSERT_THAT(estimation.estimated().label(),
+                  Eq(expected.estimated().label()));
+      ASSERT_THAT(DOUBLE(estimation.probability()),
+                  DoubleEq(DOUBLE(expected.probability())));
+    }
+  }
+}
+
+/*----------------------------------------------------------------------------*/
+
+TEST(HiddenMarkovModel, FindsTheSameLabelsWithFusedPosteriors) {
+  auto hmm = generateRandomHMM(13, 4);
+
+  for (unsigned int size : { 1, 2, 3, 16, 97 }) {
+    auto sequence = generateRandomSequence(size, 4);
+
+    auto labeler = hmm->labeler(sequence);
+    auto expected = labeler->labeling(Labeler::method::posteriorDecoding);
+
+    Matrix probabilities;
+    hmm->posteriorProbabilities(sequence, probabilities);
+
+    Posteriors posteriors;
+    posteriors.states = { 7, 2 };
+    auto estimation = labeler->labeling(posteriors);
+
+    ASSERT_THAT(estimation.estimated().label(),
+                Eq(expected.estimated().label()));
+    ASSERT_THAT(DOUBLE(estimation.probability()),
+                DoubleNear(DOUBLE(expected.probability()), 1e-12));
+
+    ASSERT_THAT(posteriors.probabilities.rows(), Eq(2u));
+    for (unsigned int i = 0; i < size; i++) {
+      auto label = estimation.estimated().label()[i];
+      ASSERT_THAT(DOUBLE(posteriors.max_posteriors[i]),
+                  DoubleNear(DOUBLE(probabilities(label, i)), 1e-12));
+      ASSERT_THAT(DOUBLE(posteriors.probabilities(0, i)),
+                  DoubleNear(DOUBLE(probabilities(7, i)), 1e-12));
+      ASSERT_THAT(DOUBLE(posteriors.probabilities(1, i)),
+                  DoubleNear(DOUBLE(probabilities(2, i)), 1e-12));
+    }
+  }
+}
+
+/*----------------------------------------------------------------------------*/
+
+TEST(HiddenMarkovModel, LabelsABatchOfSequencesInInputOrder) {
+  auto hmm = generateRandomHMM(13, 4);
+
+  std::vector<Sequence> sequences;
+  for (unsigned int size : { 3, 97, 1, 16, 97, 40, 2, 64 })
+    sequences.push_back(generateRandomSequence(size, 4));
+
+  std::vector<std::size_t> progress;
+  auto estimations = hmm->label(sequences, Labeler::method::bestPath, 4,
+    [&progress] (std::size_t labeled, std::size_t total) {
+      ASSERT_THAT(total, Eq(8u));
+      progress.push_back(labeled);
+    });
+
+  ASSERT_THAT(estimations.size(), Eq(sequences.size()));
+  ASSERT_THAT(progress, ContainerEq(std::vector<std::size_t>{
+    1, 2, 3, 4, 5, 6, 7, 8 }));
+
+  for (std::size_t i = 0; i < sequences.size(); i++) {
+    auto expected
+      = hmm->labeler(sequences[i])->labeling(Labeler::method::bestPath);
+
+    ASSERT_THAT(estimations[i].estimated().observation(),
+                Eq(sequences[i]));
+    ASSERT_THAT(estimations[i].estimated().label(),
+                Eq(expected.estimated().label()));
+    ASSERT_THAT(DOUBLE(estimations[i].probability()),
+                DoubleEq(DOUBLE(expected.probability())));
+  }
+}
+
+/*----------------------------------------------------------------------------*/
+
+TEST_F(AHiddenMarkovModel, SamplesLabelingsFromTheirPosteriorDistribution) {
+  Sequence observation { 0, 0, 1, 0, 1, 1 };
+  auto px = hmm->calculator(observation)
+              ->calculate(Calculator::direction::forward);
+
+  auto labeler = hmm->labeler(observation, true);
+  auto samples = labeler->sampling(20000, RNGAdapter<std::mt19937>::make(42));
+
+  std::map<Sequence, unsigned int> frequencies;
+  for (const auto& sample : samples) {
+    auto expected = hmm->labelingEvaluator(sample.estimated())
+                      ->evaluateSequence(0, observation.size());
+    ASSERT_THAT(DOUBLE(sample.probability() / expected),
+                DoubleNear(1.0, 1e-9));
+    frequencies[sample.estimated().label()]++;
+  }
+
+  for (const auto& sample : samples) {
+    auto label = sample.estimated().label();
+    ASSERT_THAT(frequencies[label] / 20000.0,
+                DoubleNear(DOUBLE(sample.probability() / px), 0.015));
+  }
+}
+
+/*----------------------------------------------------------------------------*/
+
+TEST(HiddenMarkovModel, DrawsTheSameSamplesWithAnyNumberOfThreads) {
+  auto hmm = generateRandomHMM(13, 4);
+  auto sequence = generateRandomSequence(50, 4);
+
+  auto labeler = hmm->labeler(sequence, true);
+  auto expected = labeler->sampling(64, RNGAdapter<std::mt19937>::make(7), 1);
+  auto samples = labeler->sampling(64, RNGAdapter<std::mt19937>::make(7), 4);
+
+  for (unsigned int s = 0; s < samples.size(); s++)
+    ASSERT_THAT(samples[s].estimated().label(),
+                Eq(expected[s].estimated().label()));
+}
+
+/*----------------------------------------------------------------------------*/
+
+TEST_F(AHiddenMarkovModel, FindsTheNMostProbableLabelings) {
+  Sequence observation { 0, 1, 1, 0, 1, 0, 0, 1 };
+
+  // Brute force over all labelings
+  std::vector<double> expected;
+  for (auto label : generateAllCombinationsOfSymbols(observation.size()))
+    expected.push_back(DOUBLE(hmm->labelingEvaluator({ observation, label })
+                                 ->evaluateSequence(0, observation.size())));
+  std::sort(expected.rbegin(), expected.rend());
+
+  for (bool lazy : { false, true }) {
+    NBest nbest;
+    nbest.size = 10;
+    nbest.lazy = lazy;
+    auto best = hmm->labeler(observation)->labeling(nbest);
+
+    ASSERT_THAT(nbest.labelings.size(), Eq(10u));
+    ASSERT_THAT(best.estimated().label(),
+                Eq(nbest.labelings[0].estimated().label()));
+
+    std::set<Sequence> labels;
+    for (unsigned int r = 0; r < nbest.labelings.size(); r++) {
+      const auto& labeling = nbest.labelings[r];
+      auto probability = hmm->labelingEvaluator(labeling.estimated())
+                           ->evaluateSequence(0, observation.size());
+
+      ASSERT_THAT(DOUBLE(labeling.probability()),
+                  DoubleNear(expected[r], 1e-12));
+      ASSERT_THAT(DOUBLE(labeling.probability()),
+                  DoubleNear(DOUBLE(probability), 1e-12));
+      labels.insert(labeling.estimated().label());
+    }
+    ASSERT_THAT(labels.size(), Eq(10u));
+  }
+}
+
+/*----------------------------------------------------------------------------*/
+
+TEST(HiddenMarkovModel, FindsTheSameNBestPathsLazily) {
+  for (auto hmm : { generateRandomHMM(13, 2), createCircularHMM(8) }) {
+    auto sequence = generateRandomSequence(60, 2);
+    auto labeler = hmm->labeler(sequence, true);
+    auto viterbi = labeler->labeling(Labeler::method::bestPath);
+
+    NBest nbest, lazy;
+    nbest.size = lazy.size = 25;
+    lazy.lazy = true;
+    labeler->labeling(nbest);
+    labeler->labeling(lazy);
+
+    ASSERT_THAT(nbest.labelings.size(), Eq(25u));
+    ASSERT_THAT(lazy.labelings.size(), Eq(25u));
+    ASSERT_THAT(DOUBLE(nbest.labelings[0].probability()),
+                DoubleNear(DOUBLE(viterbi.probability()), 1e-12));
+
+    for (unsigned int r = 0; r < nbest.labelings.size(); r++) {
+      ASSERT_THAT(DOUBLE(lazy.labelings[r].probability()
+                           / nbest.labelings[r].probability()),
+                  DoubleNear(1.0, 1e-9));
+      if (r > 0) {
+        ASSERT_THAT(DOUBLE(nbest.labelings[r].probability()),
+                    Le(DOUBLE(nbest.labelings[r-1].probability())));
+      }
+    }
+  }
+}
+
+/*----------------------------------------------------------------------------*/
+
+TEST(HiddenMarkovModel, FindsTheBestPathWithAnUnboundedBeam) {
+  auto hmm = generateRandomHMM(13, 4);
+  auto sequence = generateRandomSequence(50, 4);
+
+  auto labeler = hmm->labeler(sequence);
+  auto expected = labeler->labeling(Labeler::method::bestPath);
+
+  Beam beam;
+  beam.bounded = true;
+  auto estimation = labeler->labeling(beam);
+
+  ASSERT_THAT(estimation.estimated().label(),
+              Eq(expected.estimated().label()));
+  ASSERT_THAT(beam.cells, Eq(13u * 50u));
+  ASSERT_THAT(beam.pruningRate(), DoubleEq(0.0));
+  ASSERT_THAT(beam.score_loss_bound, DoubleEq(0.0));
+}
+
+/*----------------------------------------------------------------------------*/
+
+TEST(HiddenMarkovModel, DoesNotCountUnreachableStatesAsPruned) {
+  // Left to right: state k is only reachable from position k on
+  std::vector<HiddenMarkovModel::StatePtr> states;
+  for (unsigned int k = 0; k < 3; k++) {
+    std::vector<Probability> transitions(3);
+    transitions[k] = k == 2 ? 1.0 : 0.5;
+    if (k < 2) transitions[k + 1] = 0.5;
+    states.push_back(HiddenMarkovModel::State::make(
+      k,
+      DiscreteIIDModel::make(std::vector<Probability>{{ 0.5, 0.5 }}),
+      DiscreteIIDModel::make(transitions)));
+  }
+  auto hmm = HiddenMarkovModel::make(
+    states, DiscreteIIDModel::make(std::vector<Probability>{{ 1, 0, 0 }}),
+    3, 2);
+
+  Beam beam;
+  hmm->labeler(generateRandomSequence(10, 2))->labeling(beam);
+
+  ASSERT_THAT(beam.cells, Eq(1u + 2u + 3u * 8u));
+  ASSERT_THAT(beam.pruningRate(), DoubleEq(0.0));
+}
+
+/*----------------------------------------------------------------------------*/
+
+TEST(HiddenMarkovModel, BoundsTheScoreLostByABeam) {
+  auto hmm = generateRandomHMM(13, 4);
+  auto sequence = generateRandomSequence(50, 4);
+
+  auto labeler = hmm->labeler(sequence, true);
+  auto expected = labeler->labeling(Labeler::method::bestPath);
+
+  Beam beam;
+  beam.width = 2;
+  beam.margin = 5;
+  beam.bounded = true;
+  auto estimation = labeler->labeling(beam);
+
+  ASSERT_THAT(beam.pruned_cells, Ge(11u * 50u));
+  ASSERT_THAT(beam.score_loss_bound, Ge(0.0));
+  ASSERT_THAT(
+    std::log(DOUBLE(expected.probability() / estimation.probability())),
+    Le(beam.score_loss_bound + 1e-9));
+}
+
+/*----------------------------------------------------------------------------*/
+
+TEST(HiddenMarkovModel, UsesOnlyNonzeroTransitionsWhenSparse) {
+  const unsigned int n = 8;
+  auto hmm = createCircularHMM(n);
+  Sequence observation {0, 1, 1, 0};
+
+  ASSERT_TRUE(hmm->parameters()->sparse);
+  ASSERT_THAT(hmm->parameters()->incoming.states.size(), Eq(2 * n));
+
+  // Brute force over all n^4 labelings
+  Probability px = 0;
+  Probability best = 0;
+  for (unsigned int code = 0; code < n * n * n * n; code++) {
+    Sequence label {code % n, code / n % n, code / n / n % n, code / n / n / n};
+    auto probability = hmm->labelingEvaluator({ observation, label })
+                          ->evaluateSequence(0, observation.size());
+    px += probability;
+    if (best < probability) best = probability;
+  }
+
+  auto calculator = hmm->calculator(observation);
+  ASSERT_THAT(DOUBLE(calculator->calculate(Calculator::direction::forward)),
+              DoubleNear(DOUBLE(px), 1e-9));
+  ASSERT_THAT(DOUBLE(calculator->calculate(Calculator::direction::backward)),
+              DoubleNear(DOUBLE(px), 1e-9));
+
+  auto estimation
+    = hmm->labeler(observation)->labeling(Labeler::method::bestPath);
+  ASSERT_THAT(DOUBLE(estimation.probability()),
+              DoubleNear(DOUBLE(best), 1e-9));
+}
+
+/*----------------------------------------------------------------------------*/
+
 TEST_F(AHiddenMarkovModel, CalculatesProbabilityOfObservations) {
   std::vector<Sequence> test_set = {
     {0},
@@ -291,6 +646,51 @@ TEST_F(AHiddenMarkovModel, CalculatesForwardAndBackwardProbabilitiesWithCache) {
 
 /*----------------------------------------------------------------------------*/
 
+TEST_F(AHiddenMarkovModel, CompilesItsParametersIntoDenseTables) {
+  const auto& parameters = *hmm->parameters();
+
+  ASSERT_THAT(DOUBLE(parameters.initials[0]), DoubleNear(0.9, 1e-6));
+  ASSERT_THAT(DOUBLE(parameters.initials[1]), DoubleNear(0.1, 1e-6));
+
+  ASSERT_THAT(DOUBLE(parameters.transitions(0, 0)), DoubleNear(0.7, 1e-6));
+  ASSERT_THAT(DOUBLE(parameters.transitions(0, 1)), DoubleNear(0.3, 1e-6));
+  ASSERT_THAT(DOUBLE(parameters.transitions(1, 0)), DoubleNear(0.5, 1e-6));
+  ASSERT_THAT(DOUBLE(parameters.transitions(1, 1)), DoubleNear(0.5, 1e-6));
+
+  ASSERT_THAT(DOUBLE(parameters.emissions(0, 0)), DoubleNear(0.5, 1e-6));
+  ASSERT_THAT(DOUBLE(parameters.emissions(0, 1)), DoubleNear(0.5, 1e-6));
+  ASSERT_THAT(DOUBLE(parameters.emissions(1, 0)), DoubleNear(0.2, 1e-6));
+  ASSERT_THAT(DOUBLE(parameters.emissions(1, 1)), DoubleNear(0.8, 1e-6));
+}
+
+/*----------------------------------------------------------------------------*/
+
+TEST(HiddenMarkovModel, KeepsTheParametersReadByConcurrentLabelers) {
+  auto hmm = generateRandomHMM(13, 4);
+  auto sequence = generateRandomSequence(300, 4);
+  auto expected = hmm->labeler(sequence)
+                    ->labeling(Labeler::method::bestPath).estimated().label();
+
+  // Labelers keep the tables they started with while new ones (with the
+  // same values) are published
+  std::vector<Sequence> labels(8);
+  std::vector<std::thread> threads;
+  for (unsigned int t = 0; t < labels.size(); t++) {
+    threads.emplace_back([&, t] {
+      for (unsigned int r = 0; r < 20; r++) {
+        labels[t] = hmm->labeler(sequence)->labeling(
+          Labeler::method::bestPath).estimated().label();
+      }
+    });
+  }
+  for (unsigned int u = 0; u < 200; u++) hmm->updateParameters();
+  for (auto& thread : threads) thread.join();
+
+  for (const auto& label : labels) ASSERT_THAT(label, ContainerEq(expected));
+}
+
+/*----------------------------------------------------------------------------*/
+
 TEST_F(AHiddenMarkovModel, ShouldBeTrainedUsingBaumWelchAlgorithm) {
   auto hmm_trainer = HiddenMarkovModel::standardTrainer();
 
@@ -311,13 +711,207 @@ TEST_F(AHiddenMarkovModel, ShouldBeTrainedUsingBaumWelchAlgorithm) {
   auto evaluator11 = trained_hmm->labelingEvaluator({ seq[1], seq[1] });
 
   ASSERT_THAT(DOUBLE(evaluator00->evaluateSequence(0, 3)),
-              DoubleNear(0.191006, 1e-4));
+              DoubleNear(0.250059, 1e-4));
   ASSERT_THAT(DOUBLE(evaluator01->evaluateSequence(0, 3)),
-              DoubleNear(3.732852e-136, 1e-4));
+              DoubleNear(6.351050e-42, 1e-4));
   ASSERT_THAT(DOUBLE(evaluator10->evaluateSequence(0, 3)),
-              DoubleNear(1.1471544e-48, 1e-4));
+              DoubleNear(1.514311e-71, 1e-4));
   ASSERT_THAT(DOUBLE(evaluator11->evaluateSequence(0, 3)),
-              DoubleNear(8.91422e-137, 1e-4));
+              DoubleNear(6.360765e-42, 1e-4));
+}
+
+/*----------------------------------------------------------------------------*/
+
+TEST(HiddenMarkovModel, CountsTransitionsNextToADeadEndState) {
+  // State 2 explains the long run of zeros far better than the others,
+  // but cannot emit the final one: its alpha dwarfs theirs, its beta is 0
+  std::vector<std::vector<Probability>> emissions {
+    { 0.001, 0.999 }, { 0.002, 0.998 }, { 1.0, 0.0 } };
+  std::vector<std::vector<Probability>> transitions {
+    { 0.5, 0.4, 0.1 }, { 0.4, 0.5, 0.1 }, { 0.0, 0.0, 1.0 } };
+  std::vector<Probability> initials { 0.4, 0.4, 0.2 };
+
+  std::vector<HiddenMarkovModel::StatePtr> states;
+  for (unsigned int k = 0; k < 3; k++) {
+    states.push_back(HiddenMarkovModel::State::make(
+      k, DiscreteIIDModel::make(emissions[k]),
+      DiscreteIIDModel::make(transitions[k])));
+  }
+  auto hmm = HiddenMarkovModel::make(
+    states, DiscreteIIDModel::make(initials), 3, 2);
+
+  Sequence sequence(150, 0);
+  sequence.push_back(1);
+
+  // Expected transitions, summed in log-space
+  unsigned int T = sequence.size();
+  std::vector<std::vector<Probability>> alpha(T), beta(T);
+  for (unsigned int t = 0; t < T; t++) {
+    alpha[t].resize(3);
+    for (unsigned int j = 0; j < 3; j++) {
+      if (t == 0) alpha[t][j] = initials[j];
+      for (unsigned int i = 0; t > 0 && i < 3; i++)
+        alpha[t][j] += alpha[t-1][i] * transitions[i][j];
+      alpha[t][j] *= emissions[j][sequence[t]];
+    }
+  }
+  for (unsigned int t = T; t-- > 0; ) {
+    beta[t].assign(3, t + 1 == T ? 1.0 : 0.0);
+    for (unsigned int i = 0; t + 1 < T && i < 3; i++)
+      for (unsigned int j = 0; j < 3; j++)
+        beta[t][i] += transitions[i][j] * emissions[j][sequence[t+1]]
+                        * beta[t+1][j];
+  }
+
+  std::vector<std::vector<Probability>> xi(3, std::vector<Probability>(3));
+  for (unsigned int t = 0; t + 1 < T; t++)
+    for (unsigned int i = 0; i < 3; i++)
+      for (unsigned int j = 0; j < 3; j++)
+        xi[i][j] += alpha[t][i] * transitions[i][j]
+                      * emissions[j][sequence[t+1]] * beta[t+1][j];
+
+  auto trainer = HiddenMarkovModel::standardTrainer();
+  trainer->add_training_set({ sequence });
+  auto trained = trainer->train(
+    HiddenMarkovModel::baum_welch_algorithm{}, hmm, 1, 0.0);
+
+  for (unsigned int i = 0; i < 2; i++) {
+    Probability total = xi[i][0] + xi[i][1] + xi[i][2];
+    for (unsigned int j = 0; j < 3; j++) {
+      ASSERT_THAT(DOUBLE(trained->parameters()->transitions(i, j)),
+                  DoubleNear(DOUBLE(xi[i][j] / total), 1e-9));
+    }
+  }
+}
+
+/*----------------------------------------------------------------------------*/
+
+TEST_F(AHiddenMarkovModel,
+       ShouldBeTrainedUsingBaumWelchAlgorithmWithManyThreads) {
+  auto hmm_trainer = HiddenMarkovModel::standardTrainer();
+
+  hmm_trainer->add_training_set({
+    {0, 0, 0, 1, 1},
+    {0, 0, 0, 1, 0, 0, 1, 1},
+    {0, 0, 0, 1, 1, 0, 0},
+    {1, 1, 0, 1, 1, 1},
+    {0, 1, 0, 0, 0, 0, 1, 0, 1},
+  });
+
+  auto sequential_hmm = hmm_trainer->train(
+    HiddenMarkovModel::baum_welch_algorithm{}, hmm, 1000, 1e-4, 1);
+  auto parallel_hmm = hmm_trainer->train(
+    HiddenMarkovModel::baum_welch_algorithm{}, hmm, 1000, 1e-4, 4);
+
+  const auto& sequential = *sequential_hmm->parameters();
+  const auto& parallel = *parallel_hmm->parameters();
+
+  for (unsigned int i = 0; i < 2; i++) {
+    ASSERT_THAT(DOUBLE(parallel.initials[i]),
+                DoubleNear(DOUBLE(sequential.initials[i]), 1e-9));
+    for (unsigned int j = 0; j < 2; j++) {
+      ASSERT_THAT(DOUBLE(parallel.transitions(i, j)),
+                  DoubleNear(DOUBLE(sequential.transitions(i, j)), 1e-9));
+      ASSERT_THAT(DOUBLE(parallel.emissions(i, j)),
+                  DoubleNear(DOUBLE(sequential.emissions(i, j)), 1e-9));
+    }
+  }
+}
+
+/*----------------------------------------------------------------------------*/
+
+TEST_F(AHiddenMarkovModel, ShouldBeTrainedUsingOnlineBaumWelchAlgorithm) {
+  std::vector<Sequence> training_set {
+    {0, 0, 0, 1, 1},
+    {0, 0, 0, 1, 0, 0, 1, 1},
+    {0, 0, 0, 1, 1, 0, 0},
+  };
+
+  unsigned int streamed = 0;
+  auto next_sequence = [&](Sequence& sequence) {
+    if (streamed == 300) return false;
+    sequence = training_set[streamed++ % training_set.size()];
+    return true;
+  };
+
+  std::vector<HiddenMarkovModelPtr> snapshots;
+  auto hmm_trainer = HiddenMarkovModel::standardTrainer();
+  auto trained_hmm = hmm_trainer->train(
+    HiddenMarkovModel::online_baum_welch_algorithm{}, hmm,
+    next_sequence, 0.7, 100,
+    [&](HiddenMarkovModelPtr snapshot) { snapshots.push_back(snapshot); });
+
+  ASSERT_THAT(snapshots.size(), Eq(3u));
+
+  auto log_likelihood = [&](HiddenMarkovModelPtr model) {
+    double sum = 0;
+    for (const auto& sequence : training_set) {
+      auto calculator = model->calculator(sequence);
+      sum += std::log(
+        DOUBLE(calculator->calculate(Calculator::direction::forward)));
+    }
+    return sum;
+  };
+
+  ASSERT_THAT(log_likelihood(trained_hmm), Ge(log_likelihood(hmm)));
+  ASSERT_THAT(log_likelihood(trained_hmm),
+              DoubleNear(log_likelihood(snapshots.back()), 1e-9));
+}
+
+/*----------------------------------------------------------------------------*/
+
+TEST_F(AHiddenMarkovModel, ShouldRejectOnlineBaumWelchDecaysOutOfRange) {
+  auto hmm_trainer = HiddenMarkovModel::standardTrainer();
+  hmm_trainer->add_training_set({ {0, 0, 0, 1, 1} });
+
+  for (double decay : { -1.0, 0.0, 0.5, 1.5 }) {
+    ASSERT_THROW(hmm_trainer->train(
+                   HiddenMarkovModel::online_baum_welch_algorithm{}, hmm,
+                   nullptr, decay),
+                 OutOfRange);
+  }
+  ASSERT_NO_THROW(hmm_trainer->train(
+                    HiddenMarkovModel::online_baum_welch_algorithm{}, hmm,
+                    nullptr, 1.0));
+}
+
+/*----------------------------------------------------------------------------*/
+
+TEST_F(AHiddenMarkovModel, ShouldCountBestPathsUsingViterbiTraining) {
+  std::vector<Sequence> training_set {
+    {0, 0, 0, 1, 1, 0, 1, 0, 1, 1, 1, 1, 1, 1, 1, 1, 0, 1, 1, 1, 1, 0, 0, 1},
+    {1, 1, 1, 1, 1, 1, 0, 1, 1, 1, 0, 0, 1, 0, 0, 1, 0},
+    {0, 0, 0, 1, 0, 0, 1, 1},
+  };
+
+  auto hmm_trainer = HiddenMarkovModel::standardTrainer();
+  auto labeling_trainer = HiddenMarkovModel::labelingTrainer();
+  for (const auto& sequence : training_set) {
+    hmm_trainer->add_training_sequence(sequence);
+    labeling_trainer->add_training_sequence(
+      hmm->labeler(sequence)->labeling(Labeler::method::bestPath)
+         .estimated());
+  }
+
+  // A single iteration estimates the model from the decoded labelings
+  auto trained_hmm = hmm_trainer->train(
+    HiddenMarkovModel::viterbi_training_algorithm{}, hmm, 1, 0.0, 3);
+  auto expected_hmm = labeling_trainer->train(
+    HiddenMarkovModel::maximum_likehood_algorithm{}, 2, 2, 0.0);
+
+  const auto& trained = *trained_hmm->parameters();
+  const auto& expected = *expected_hmm->parameters();
+
+  for (unsigned int k = 0; k < 2; k++) {
+    ASSERT_THAT(DOUBLE(trained.initials[k]),
+                DoubleNear(DOUBLE(expected.initials[k]), 1e-9));
+    for (unsigned int l = 0; l < 2; l++)
+      ASSERT_THAT(DOUBLE(trained.transitions(k, l)),
+                  DoubleNear(DOUBLE(expected.transitions(k, l)), 1e-9));
+    for (unsigned int s = 0; s < 2; s++)
+      ASSERT_THAT(DOUBLE(trained.emissions(k, s)),
+                  DoubleNear(DOUBLE(expected.emissions(k, s)), 1e-9));
+  }
 }
 
 /*----------------------------------------------------------------------------*/
@@ -0,0 +1,105 @@
+/***********************************************************************/
+/*  Copyright 2015 ToPS                                                */
+/*                                                                     */
+/*  This program is free software; you can redistribute it and/or      */
+/*  modify it under the terms of the GNU  General Public License as    */
+/*  published by the Free Software Foundation; either version 3 of     */
+/*  the License, or (at your option) any later version.                */
+/*                                                                     */
+/*  This program is distributed in the hope that it will be useful,    */
+/*  but WITHOUT ANY WARRANTY; without even the implied warranty of     */
+/*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the      */
+/*  GNU General Public License for more details.                       */
+/*                                                                     */
+/*  You should have received a copy of the GNU General Public License  */
+/*  along with this program; if not, write to the Free Software        */
+/*  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,         */
+/*  MA 02110-1301, USA.                                                */
+/***********************************************************************/
+
+// Standard headers
+#include <vector>
+#include <cstdint>
+
+// External headers
+#include "gmock/gmock.h"
+
+// Tested header
+#include "model/Matrix.hpp"
+
+/*----------------------------------------------------------------------------*/
+/*                             USING DECLARATIONS                             */
+/*----------------------------------------------------------------------------*/
+
+using ::testing::Eq;
+using ::testing::ContainerEq;
+
+using tops::model::IndexMatrix;
+
+/*----------------------------------------------------------------------------*/
+/*                                SIMPLE TESTS                                */
+/*----------------------------------------------------------------------------*/
+
+TEST(AMatrix, ShouldStoreElementsContiguouslyByPosition) {
+  IndexMatrix m(3, 4);
+  for (unsigned int k = 0; k < 3; k++)
+    for (unsigned int i = 0; i < 4; i++)
+      m(k, i) = 10 * k + i;
+
+  ASSERT_THAT(m.column(2).stride(), Eq(1u));
+  ASSERT_THAT(std::vector<unsigned int>(m.column(2).begin(), m.column(2).end()),
+              ContainerEq(std::vector<unsigned int>{ 2, 12, 22 }));
+  ASSERT_THAT(m.data()[3 * 1 + 2], Eq(21u));
+}
+
+/*----------------------------------------------------------------------------*/
+
+TEST(AMatrix, ShouldStoreElementsContiguouslyByState) {
+  IndexMatrix m(3, 4, IndexMatrix::layout::stateMajor);
+  for (unsigned int k = 0; k < 3; k++)
+    for (unsigned int i = 0; i < 4; i++)
+      m(k, i) = 10 * k + i;
+
+  ASSERT_THAT(m.row(1).stride(), Eq(1u));
+  ASSERT_THAT(std::vector<unsigned int>(m[1].begin(), m[1].end()),
+              ContainerEq(std::vector<unsigned int>{ 10, 11, 12, 13 }));
+  ASSERT_THAT(m.data()[4 * 2 + 1], Eq(21u));
+}
+
+/*----------------------------------------------------------------------------*/
+
+TEST(AMatrix, ShouldKeepElementsWhenChangingLayout) {
+  IndexMatrix m(2, 3);
+  for (unsigned int k = 0; k < 2; k++)
+    for (unsigned int i = 0; i < 3; i++)
+      m(k, i) = 10 * k + i;
+
+  m.relayout(IndexMatrix::layout::stateMajor);
+
+  ASSERT_THAT(m.memoryLayout(), Eq(IndexMatrix::layout::stateMajor));
+  for (unsigned int k = 0; k < 2; k++)
+    for (unsigned int i = 0; i < 3; i++)
+      ASSERT_THAT(m[k][i], Eq(10 * k + i));
+}
+
+/*----------------------------------------------------------------------------*/
+
+TEST(AMatrix, ShouldBeAlignedToACacheLine) {
+  IndexMatrix m(5, 7);
+  ASSERT_THAT(reinterpret_cast<std::uintptr_t>(m.data()) % 64, Eq(0u));
+}
+
+/*----------------------------------------------------------------------------*/
+
+TEST(AMatrix, ShouldReuseItsStorageWhenReset) {
+  IndexMatrix m(4, 100, IndexMatrix::layout::positionMajor, 7);
+  auto data = m.data();
+
+  m.reset(4, 50, 3);
+
+  ASSERT_THAT(m.data(), Eq(data));
+  ASSERT_THAT(m.columns(), Eq(50u));
+  ASSERT_THAT(m(3, 49), Eq(3u));
+}
+
+/*----------------------------------------------------------------------------*/
@@ -0,0 +1,128 @@
+/***********************************************************************/
+/*  Copyright 2015 ToPS                                                */
+/*                                                                     */
+/*  This program is free software; you can redistribute it and/or      */
+/*  modify it under the terms of the GNU  General Public License as    */
+/*  published by the Free Software Foundation; either version 3 of     */
+/*  the License, or (at your option) any later version.                */
+/*                                                                     */
+/*  This program is distributed in the hope that it will be useful,    */
+/*  but WITHOUT ANY WARRANTY; without even the implied warranty of     */
+/*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the      */
+/*  GNU General Public License for more details.                       */
+/*                                                                     */
+/*  You should have received a copy of the GNU General Public License  */
+/*  along with this program; if not, write to the Free Software        */
+/*  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,         */
+/*  MA 02110-1301, USA.                                                */
+/***********************************************************************/
+
+// Standard headers
+#include <vector>
+#include <random>
+
+// External headers
+#include "gmock/gmock.h"
+
+// ToPS headers
+#include "model/Labeling.hpp"
+#include "model/Sequence.hpp"
+#include "model/HiddenMarkovModel.hpp"
+#include "model/RandomNumberGeneratorAdapter.hpp"
+
+#include "helper/HiddenMarkovModel.hpp"
+
+// Tested header
+#include "model/Simulator.hpp"
+
+/*----------------------------------------------------------------------------*/
+/*                             USING DECLARATIONS                             */
+/*----------------------------------------------------------------------------*/
+
+using ::testing::Eq;
+using ::testing::Ne;
+using ::testing::Lt;
+using ::testing::DoubleNear;
+using ::testing::ContainerEq;
+
+using tops::model::Labeling;
+using tops::model::Sequence;
+using tops::model::Simulator;
+using tops::model::RNGAdapter;
+
+using tops::helper::generateRandomHMM;
+using tops::helper::createDishonestCoinCasinoHMM;
+
+/*----------------------------------------------------------------------------*/
+/*                                SIMPLE TESTS                                */
+/*----------------------------------------------------------------------------*/
+
+TEST(Simulator, DrawsSequencesWithTheModelsFrequencies) {
+  auto hmm = createDishonestCoinCasinoHMM();
+  const auto& parameters = *hmm->parameters();
+
+  auto labelings = Simulator::make(hmm)->simulate(200, 500, 42);
+
+  std::vector<double> visits(2), transitions(4), emissions(4);
+  for (const auto& labeling : labelings) {
+    ASSERT_THAT(labeling.observation().size(), Eq(500u));
+    ASSERT_THAT(labeling.label().size(), Eq(500u));
+
+    for (unsigned int i = 0; i < 500; i++) {
+      auto k = labeling.label()[i];
+      emissions[2 * k + labeling.observation()[i]]++;
+      if (i + 1 < 500) {
+        visits[k]++;
+        transitions[2 * k + labeling.label()[i+1]]++;
+      }
+    }
+  }
+
+  for (unsigned int k = 0; k < 2; k++) {
+    for (unsigned int l = 0; l < 2; l++) {
+      ASSERT_THAT(transitions[2 * k + l] / visits[k],
+                  DoubleNear(static_cast<double>(
+                    parameters.transitions(k, l)), 0.01));
+      ASSERT_THAT(emissions[2 * k + l]
+                    / (emissions[2 * k] + emissions[2 * k + 1]),
+                  DoubleNear(static_cast<double>(
+                    parameters.emissions(k, l)), 0.01));
+    }
+  }
+}
+
+/*----------------------------------------------------------------------------*/
+
+TEST(Simulator, DrawsTheSameSequencesWithAnyNumberOfThreads) {
+  auto simulator = Simulator::make(generateRandomHMM(13, 4));
+
+  auto sequential = simulator->simulate(20, 300, 7, 1);
+  auto parallel = simulator->simulate(20, 300, 7, 4);
+
+  for (unsigned int i = 0; i < sequential.size(); i++) {
+    ASSERT_THAT(parallel[i].observation(),
+                ContainerEq(sequential[i].observation()));
+    ASSERT_THAT(parallel[i].label(), ContainerEq(sequential[i].label()));
+  }
+  ASSERT_THAT(sequential[0].label(), Ne(sequential[1].label()));
+}
+
+/*----------------------------------------------------------------------------*/
+
+TEST(Simulator, ReusesTheStorageOfItsBuffers) {
+  auto simulator = Simulator::make(generateRandomHMM(5, 3));
+  auto rng = RNGAdapter<std::mt19937>::make(42);
+
+  Labeling<Sequence> buffer;
+  simulator->draw(1000, rng, buffer);
+  auto data = buffer.observation().data();
+
+  simulator->draw(600, rng, buffer);
+  ASSERT_THAT(buffer.observation().size(), Eq(600u));
+  ASSERT_THAT(buffer.label().size(), Eq(600u));
+  ASSERT_THAT(buffer.observation().data(), Eq(data));
+  for (auto symbol : buffer.observation()) ASSERT_THAT(symbol, Lt(3u));
+  for (auto state : buffer.label()) ASSERT_THAT(state, Lt(5u));
+}
+
+/*----------------------------------------------------------------------------*/
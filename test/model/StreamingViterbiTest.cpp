@@ -0,0 +1,116 @@
+/***********************************************************************/
+/*  Copyright 2015 ToPS                                                */
+/*                                                                     */
+/*  This program is free software; you can redistribute it and/or      */
+/*  modify it under the terms of the GNU  General Public License as    */
+/*  published by the Free Software Foundation; either version 3 of     */
+/*  the License, or (at your option) any later version.                */
+/*                                                                     */
+/*  This program is distributed in the hope that it will be useful,    */
+/*  but WITHOUT ANY WARRANTY; without even the implied warranty of     */
+/*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the      */
+/*  GNU General Public License for more details.                       */
+/*                                                                     */
+/*  You should have received a copy of the GNU General Public License  */
+/*  along with this program; if not, write to the Free Software        */
+/*  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,         */
+/*  MA 02110-1301, USA.                                                */
+/***********************************************************************/
+
+// Standard headers
+#include <vector>
+#include <algorithm>
+
+// External headers
+#include "gmock/gmock.h"
+
+// ToPS headers
+#include "model/Sequence.hpp"
+#include "model/HiddenMarkovModel.hpp"
+
+#include "helper/Sequence.hpp"
+#include "helper/HiddenMarkovModel.hpp"
+
+// Tested header
+#include "model/StreamingViterbi.hpp"
+
+/*----------------------------------------------------------------------------*/
+/*                             USING DECLARATIONS                             */
+/*----------------------------------------------------------------------------*/
+
+using ::testing::Eq;
+using ::testing::Le;
+using ::testing::Gt;
+using ::testing::ContainerEq;
+
+using tops::model::Labeler;
+using tops::model::Sequence;
+using tops::model::StreamingViterbi;
+
+using tops::helper::generateRandomHMM;
+using tops::helper::generateRandomSequence;
+using tops::helper::createDishonestCoinCasinoHMM;
+
+/*----------------------------------------------------------------------------*/
+/*                                SIMPLE TESTS                                */
+/*----------------------------------------------------------------------------*/
+
+TEST(StreamingViterbi, FindsTheBestPathWhenTheLagCoversTheStream) {
+  auto hmm = generateRandomHMM(13, 4);
+  auto sequence = generateRandomSequence(200, 4);
+  auto expected = hmm->labeler(sequence)->labeling(Labeler::method::bestPath);
+
+  auto decoder = StreamingViterbi::make(hmm, 200);
+
+  Sequence labels;
+  for (unsigned int begin = 0, size = 1; begin < sequence.size();
+       begin += size, size = 2 * size + 1) {
+    auto end = std::min<std::size_t>(begin + size, sequence.size());
+    auto chunk = decoder->push(Sequence(sequence.begin() + begin,
+                                        sequence.begin() + end));
+    labels.insert(labels.end(), chunk.begin(), chunk.end());
+    ASSERT_THAT(decoder->committed(), Eq(labels.size()));
+  }
+  auto chunk = decoder->finish();
+  labels.insert(labels.end(), chunk.begin(), chunk.end());
+
+  ASSERT_THAT(labels, ContainerEq(expected.estimated().label()));
+}
+
+/*----------------------------------------------------------------------------*/
+
+TEST(StreamingViterbi, CommitsLabelsWhenAllPathsConverge) {
+  auto hmm = createDishonestCoinCasinoHMM();
+  Sequence sequence(100, 0);
+  sequence.insert(sequence.end(), 100, 1);
+  auto expected = hmm->labeler(sequence)->labeling(Labeler::method::bestPath);
+
+  auto decoder = StreamingViterbi::make(hmm, 1000);
+  auto labels = decoder->push(sequence);
+
+  ASSERT_THAT(labels.size(), Gt(0u));
+  ASSERT_THAT(labels, ContainerEq(Sequence(
+    expected.estimated().label().begin(),
+    expected.estimated().label().begin() + labels.size())));
+}
+
+/*----------------------------------------------------------------------------*/
+
+TEST(StreamingViterbi, NeverKeepsMoreLabelsThanTheLag) {
+  auto hmm = generateRandomHMM(13, 4);
+  auto decoder = StreamingViterbi::make(hmm, 8);
+
+  std::size_t symbols = 0, labels = 0;
+  for (unsigned int chunk = 0; chunk < 50; chunk++) {
+    symbols += chunk % 7 + 1;
+    labels += decoder->push(generateRandomSequence(chunk % 7 + 1, 4)).size();
+    ASSERT_THAT(decoder->committed(), Eq(labels));
+    ASSERT_THAT(decoder->position() - decoder->committed(), Le(8u));
+  }
+  labels += decoder->finish().size();
+
+  ASSERT_THAT(labels, Eq(symbols));
+  ASSERT_THAT(decoder->position(), Eq(0u));
+}
+
+/*----------------------------------------------------------------------------*/
@@ -0,0 +1,76 @@
+/***********************************************************************/
+/*  Copyright 2015 ToPS                                                */
+/*                                                                     */
+/*  This program is free software; you can redistribute it and/or      */
+/*  modify it under the terms of the GNU  General Public License as    */
+/*  published by the Free Software Foundation; either version 3 of     */
+/*  the License, or (at your option) any later version.                */
+/*                                                                     */
+/*  This program is distributed in the hope that it will be useful,    */
+/*  but WITHOUT ANY WARRANTY; without even the implied warranty of     */
+/*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the      */
+/*  GNU General Public License for more details.                       */
+/*                                                                     */
+/*  You should have received a copy of the GNU General Public License  */
+/*  along with this program; if not, write to the Free Software        */
+/*  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,         */
+/*  MA 02110-1301, USA.                                                */
+/***********************************************************************/
+
+// Standard headers
+#include <vector>
+#include <stdexcept>
+
+// External headers
+#include "gmock/gmock.h"
+
+// Tested header
+#include "model/ThreadPool.hpp"
+
+/*----------------------------------------------------------------------------*/
+/*                             USING DECLARATIONS                             */
+/*----------------------------------------------------------------------------*/
+
+using ::testing::Eq;
+using ::testing::Each;
+using ::testing::Lt;
+
+using tops::model::ThreadPool;
+
+/*----------------------------------------------------------------------------*/
+/*                                SIMPLE TESTS                                */
+/*----------------------------------------------------------------------------*/
+
+TEST(ThreadPool, ShouldRunEveryIterationExactlyOnce) {
+  auto pool = ThreadPool::make(4);
+  std::vector<unsigned int> runs(1000, 0);
+  std::vector<unsigned int> workers(1000, 0);
+
+  for (unsigned int loop = 0; loop < 10; loop++) {
+    pool->parallelFor(runs.size(), [&](std::size_t i, unsigned int worker) {
+      runs[i]++;
+      workers[i] = worker;
+    });
+  }
+
+  ASSERT_THAT(pool->size(), Eq(4u));
+  ASSERT_THAT(runs, Each(Eq(10u)));
+  ASSERT_THAT(workers, Each(Lt(4u)));
+}
+
+/*----------------------------------------------------------------------------*/
+
+TEST(ThreadPool, ShouldRethrowExceptionsOfTheIterations) {
+  auto pool = ThreadPool::make(4);
+
+  ASSERT_THROW(
+    pool->parallelFor(100, [](std::size_t i, unsigned int) {
+      if (i == 42) throw std::runtime_error("Iteration failed");
+    }), std::runtime_error);
+
+  unsigned int count = 0;
+  pool->parallelFor(1, [&](std::size_t, unsigned int) { count++; });
+  ASSERT_THAT(count, Eq(1u));
+}
+
+/*----------------------------------------------------------------------------*/
@@ -0,0 +1,105 @@
+/***********************************************************************/
+/*  Copyright 2015 ToPS                                                */
+/*                                                                     */
+/*  This program is free software; you can redistribute it and/or      */
+/*  modify it under the terms of the GNU  General Public License as    */
+/*  published by the Free Software Foundation; either version 3 of     */
+/*  the License, or (at your option) any later version.                */
+/*                                                                     */
+/*  This program is distributed in the hope that it will be useful,    */
+/*  but WITHOUT ANY WARRANTY; without even the implied warranty of     */
+/*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the      */
+/*  GNU General Public License for more details.                       */
+/*                                                                     */
+/*  You should have received a copy of the GNU General Public License  */
+/*  along with this program; if not, write to the Free Software        */
+/*  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,         */
+/*  MA 02110-1301, USA.                                                */
+/***********************************************************************/
+
+// Standard headers
+#include <cmath>
+#include <limits>
+#include <random>
+#include <vector>
+
+// External headers
+#include "gmock/gmock.h"
+
+// Tested header
+#include "model/ViterbiKernel.hpp"
+
+/*----------------------------------------------------------------------------*/
+/*                             USING DECLARATIONS                             */
+/*----------------------------------------------------------------------------*/
+
+using ::testing::DoubleEq;
+using ::testing::ContainerEq;
+
+using tops::model::ViterbiKernel;
+
+/*----------------------------------------------------------------------------*/
+/*                                SIMPLE TESTS                                */
+/*----------------------------------------------------------------------------*/
+
+TEST(ViterbiKernel, ShouldMaximizeOverPredecessors) {
+  std::vector<double> previous { std::log(0.5), std::log(0.5) };
+  std::vector<double> transitions { std::log(0.7), std::log(0.3),
+                                    std::log(0.5), std::log(0.5) };
+  std::vector<double> emissions { std::log(0.5), std::log(0.8) };
+
+  std::vector<double> current(2);
+  std::vector<unsigned int> backpointers(2);
+
+  ViterbiKernel::step(ViterbiKernel::extension::scalar, 2,
+                      previous.data(), transitions.data(), emissions.data(),
+                      current.data(), backpointers.data());
+
+  ASSERT_THAT(current[0], DoubleEq(std::log(0.5 * 0.7 * 0.5)));
+  ASSERT_THAT(current[1], DoubleEq(std::log(0.5 * 0.5 * 0.8)));
+  ASSERT_THAT(backpointers, ContainerEq(std::vector<unsigned int>{ 0, 1 }));
+}
+
+/*----------------------------------------------------------------------------*/
+
+TEST(ViterbiKernel, ShouldGiveTheSameResultsWithAllExtensions) {
+  const unsigned int n = 11;
+  const double impossible = -std::numeric_limits<double>::infinity();
+
+  std::mt19937 generator(42);
+  std::uniform_real_distribution<double> distribution(-10.0, 0.0);
+
+  std::vector<double> previous(n), transitions(n * n), emissions(n);
+  for (auto& v : previous) v = distribution(generator);
+  for (auto& v : transitions) v = distribution(generator);
+  for (auto& v : emissions) v = distribution(generator);
+
+  // Forbidden transitions and a state unreachable from all others
+  transitions[3 * n + 5] = impossible;
+  for (unsigned int p = 0; p < n; p++)
+    transitions[p * n + 7] = impossible;
+
+  std::vector<double> expected_current(n);
+  std::vector<unsigned int> expected_backpointers(n);
+  ViterbiKernel::step(ViterbiKernel::extension::scalar, n,
+                      previous.data(), transitions.data(), emissions.data(),
+                      expected_current.data(), expected_backpointers.data());
+
+  for (auto extension : { ViterbiKernel::extension::sse4,
+                          ViterbiKernel::extension::avx2 }) {
+    if (static_cast<int>(extension)
+          > static_cast<int>(ViterbiKernel::available()))
+      continue;
+
+    std::vector<double> current(n);
+    std::vector<unsigned int> backpointers(n);
+    ViterbiKernel::step(extension, n,
+                        previous.data(), transitions.data(), emissions.data(),
+                        current.data(), backpointers.data());
+
+    ASSERT_THAT(current, ContainerEq(expected_current));
+    ASSERT_THAT(backpointers, ContainerEq(expected_backpointers));
+  }
+}
+
+/*----------------------------------------------------------------------------*/